@@ -20,28 +20,254 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <splayer/batch/thumbnailer.h>
+#include <splayer/bench/bench.h>
 #include <splayer/codec/decode/hw_decode.h>
 #include <splayer/splayer.h>
+#include <splayer/util/memory_budget.h>
+#include <splayer/util/profiler.h>
 #include <splayer/window/window.h>
 
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace {
 std::unique_ptr<splayer::SplayerApp> splayer_app;
 }
 
 int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        std::cout << "Usage is ./splayer [filename]\n";
+    constexpr auto usage =
+        "Usage is ./splayer [--bench [--json path]] [--decoder auto|hw|sw | --hw] [--probe-cache]"
+        " [--profile] [--trace path] [--mmap | --readahead <MiB>] [--no-governor]"
+        " [--mem-budget <MiB>] [filename...]\n"
+        "         ./splayer --wall [--wall-workers <n>] [--wall-frames <n>] filename...\n"
+        "         ./splayer --thumbs [--keyframes | --interval <s>] [--size <w>x<h>] [--out dir]"
+        " [--max <n>] [--jobs <n>] [--writers <n>] [--decoder auto|hw|sw] [--json path]"
+        " filename...\n"
+        "         ./splayer --cnvt-bench|--slice-bench|--upload-bench|--sched-bench [--json path]\n"
+        "         ./splayer --io-bench [--cold] [--readahead <MiB>] [--json path] filename\n"
+        "         ./splayer --thread-bench [--decoder auto|hw|sw] [--json path] filename\n"
+        "         ./splayer --leak-bench [--passes <n>] [--json path] filename\n"
+        "         ./splayer --alloc-bench [--json path] filename\n"
+        "Bench options: --slices <n> conversion slices per frame\n"
+        "Decoder threading: --threads <n> (0 = auto), --thread-type frame|slice|both,"
+        " --low-delay\n";
+
+    bool bench{false};
+    bool cnvt_bench{false};
+    bool slice_bench{false};
+    bool io_bench{false};
+    bool thread_bench{false};
+    bool leak_bench{false};
+    bool alloc_bench{false};
+    bool upload_bench{false};
+    bool sched_bench{false};
+    bool wall{false};
+    bool thumbs{false};
+    // Every input, played back to back unless --wall or --thumbs is given
+    std::vector<std::string> inputs;
+    bool profile{false};
+    std::string trace_path;
+    splayer::BenchOptions bench_opts;
+    splayer::AppOptions app_opts;
+    splayer::ThumbOptions thumb_opts;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg(argv[i]);
+
+        if (arg == "--bench") {
+            bench = true;
+        } else if (arg == "--cnvt-bench") {
+            cnvt_bench = true;
+        } else if (arg == "--slice-bench") {
+            slice_bench = true;
+        } else if (arg == "--slices" && i + 1 < argc) {
+            bench_opts.cnvt_slices = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--hw") {
+            // Short for --decoder hw
+            bench_opts.decoder = app_opts.decoder = splayer::DecoderPreference::HARDWARE;
+        } else if (arg == "--decoder" && i + 1 < argc) {
+            const std::string_view pref(argv[++i]);
+            if (pref == "auto") {
+                bench_opts.decoder = app_opts.decoder = splayer::DecoderPreference::AUTO;
+            } else if (pref == "hw") {
+                bench_opts.decoder = app_opts.decoder = splayer::DecoderPreference::HARDWARE;
+            } else if (pref == "sw") {
+                bench_opts.decoder = app_opts.decoder = splayer::DecoderPreference::SOFTWARE;
+            } else {
+                std::cout << usage;
+                return -1;
+            }
+        } else if (arg == "--json" && i + 1 < argc) {
+            bench_opts.json_path = argv[++i];
+        } else if (arg == "--io-bench") {
+            io_bench = true;
+        } else if (arg == "--thread-bench") {
+            thread_bench = true;
+        } else if (arg == "--upload-bench") {
+            upload_bench = true;
+        } else if (arg == "--sched-bench") {
+            sched_bench = true;
+        } else if (arg == "--alloc-bench") {
+            alloc_bench = true;
+        } else if (arg == "--leak-bench") {
+            leak_bench = true;
+        } else if (arg == "--passes" && i + 1 < argc) {
+            bench_opts.leak_passes = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            const int n = static_cast<int>(std::strtol(argv[++i], nullptr, 10));
+            bench_opts.threading.threads = app_opts.threading.threads = std::max(n, 0);
+        } else if (arg == "--thread-type" && i + 1 < argc) {
+            const std::string_view type(argv[++i]);
+            if (type == "frame") {
+                bench_opts.threading.type = app_opts.threading.type = splayer::ThreadType::FRAME;
+            } else if (type == "slice") {
+                bench_opts.threading.type = app_opts.threading.type = splayer::ThreadType::SLICE;
+            } else if (type == "both") {
+                bench_opts.threading.type = app_opts.threading.type = splayer::ThreadType::BOTH;
+            } else {
+                std::cout << usage;
+                return -1;
+            }
+        } else if (arg == "--no-governor") {
+            app_opts.load_governor = false;
+        } else if (arg == "--low-delay") {
+            bench_opts.threading.low_delay = app_opts.threading.low_delay = true;
+        } else if (arg == "--mmap") {
+            bench_opts.input_io = app_opts.input_io = splayer::InputIoMode::MMAP;
+        } else if (arg == "--readahead" && i + 1 < argc) {
+            // 1 MiB blocks, the window is given in MiB
+            const auto mib = std::max(std::strtoul(argv[++i], nullptr, 10), 2UL);
+            bench_opts.input_io = app_opts.input_io = splayer::InputIoMode::READAHEAD;
+            bench_opts.input_io_cfg.readahead_blocks = app_opts.input_io_cfg.readahead_blocks = mib;
+        } else if (arg == "--cold") {
+            bench_opts.cold_cache = true;
+        } else if (arg == "--probe-cache") {
+            bench_opts.probe_cache = app_opts.probe_cache = true;
+        } else if (arg == "--wall") {
+            wall = true;
+        } else if (arg == "--wall-workers" && i + 1 < argc) {
+            app_opts.wall.workers = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--wall-frames" && i + 1 < argc) {
+            app_opts.wall.max_in_flight = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--thumbs") {
+            thumbs = true;
+        } else if (arg == "--keyframes") {
+            thumb_opts.mode = splayer::ThumbMode::KEYFRAMES;
+        } else if (arg == "--interval" && i + 1 < argc) {
+            thumb_opts.interval_s = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--size" && i + 1 < argc) {
+            char *end{};
+            thumb_opts.width = static_cast<int>(std::strtol(argv[++i], &end, 10));
+            thumb_opts.height = (*end == 'x' ? static_cast<int>(std::strtol(end + 1, nullptr, 10))
+                                             : 0);
+        } else if (arg == "--out" && i + 1 < argc) {
+            thumb_opts.out_dir = argv[++i];
+        } else if (arg == "--max" && i + 1 < argc) {
+            thumb_opts.max_per_file = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--jobs" && i + 1 < argc) {
+            thumb_opts.jobs = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--writers" && i + 1 < argc) {
+            thumb_opts.writers = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--mem-budget" && i + 1 < argc) {
+            utils::MemoryBudget::set_limit(std::strtoull(argv[++i], nullptr, 10) << 20);
+        } else if (arg == "--profile") {
+            profile = true;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (!arg.starts_with("--")) {
+            if (bench_opts.url.empty()) {
+                bench_opts.url = arg;
+            }
+
+            inputs.emplace_back(arg);
+        } else {
+            std::cout << usage;
+            return -1;
+        }
+    }
+
+    // --json only means something to the benches and the thumbnailer
+    const bool any_bench = (bench || cnvt_bench || slice_bench || upload_bench || sched_bench ||
+                            io_bench || thread_bench || leak_bench || alloc_bench);
+    if (!bench_opts.json_path.empty() && !any_bench && !thumbs) {
+        std::cout << usage;
+        return -1;
+    }
+
+    if (cnvt_bench) {
+        return splayer::run_cnvt_bench(bench_opts);
+    } else if (slice_bench) {
+        return splayer::run_slice_bench(bench_opts);
+    } else if (upload_bench) {
+        return splayer::run_upload_bench(bench_opts);
+    } else if (sched_bench) {
+        return splayer::run_sched_bench(bench_opts);
+    }
+
+    // The benches take a single input
+    const bool single_input = (bench || io_bench || thread_bench || leak_bench || alloc_bench);
+    if (bench_opts.url.empty() || (single_input && inputs.size() > 1)) {
+        std::cout << usage;
         return -1;
     }
 
-    const std::string vid_file(argv[1]);
+    if (profile || !trace_path.empty()) {
+        utils::Profiler::enable(!trace_path.empty());
+    }
+
+    int ret = 0;
+
+    if (bench) {
+        ret = splayer::run_bench(bench_opts);
+    } else if (io_bench) {
+        ret = splayer::run_io_bench(bench_opts);
+    } else if (thread_bench) {
+        ret = splayer::run_thread_bench(bench_opts);
+    } else if (alloc_bench) {
+        ret = splayer::run_alloc_bench(bench_opts);
+    } else if (leak_bench) {
+        ret = splayer::run_leak_bench(bench_opts);
+    } else if (thumbs) {
+        thumb_opts.inputs = inputs;
+        thumb_opts.json_path = bench_opts.json_path;
+        thumb_opts.decoder = bench_opts.decoder;
+        ret = splayer::run_thumbnails(thumb_opts);
+    } else if (wall) {
+        try {
+            splayer::VideoWallApp wall_app(inputs, app_opts);
+            wall_app.gui_loop();
+        } catch (const splayer::DecoderError &e) {
+            std::cout << "Error: " << e.error_string() << '\n';
+        }
+    } else {
+        try {
+            splayer_app = std::make_unique<splayer::SplayerApp>(inputs, app_opts);
+            splayer_app->gui_loop();
+        } catch (const splayer::DecoderError &e) {
+            std::cout << "Error: " << e.error_string() << '\n';
+        }
 
-    try {
-        splayer_app = std::make_unique<splayer::SplayerApp>(vid_file);
-        splayer_app->gui_loop();
-    } catch (const splayer::DecoderError &e) {
-        std::cout << "Error: " << e.error_string() << '\n';
+        // Joins the pipeline threads before their zones are read
+        splayer_app.reset();
     }
-}
\ No newline at end of file
+
+    if (const auto mem = utils::MemoryBudget::usage(); mem.limit > 0) {
+        std::cout << "Frame memory peaked at " << (mem.peak >> 20) << " of " << (mem.limit >> 20)
+                  << " MiB\n";
+    }
+
+    if (utils::Profiler::enabled()) {
+        utils::Profiler::log_summary();
+    }
+
+    if (!trace_path.empty() && !utils::Profiler::write_trace(trace_path)) {
+        std::cout << "Failed to write trace to " << trace_path << '\n';
+    }
+
+    return ret;
+}
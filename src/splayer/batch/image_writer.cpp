@@ -0,0 +1,153 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "image_writer.h"
+
+#include <splayer/codec/decode/decoder.h>
+#include <splayer/util/utils.h>
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+using namespace utils;
+
+namespace splayer {
+ImageWriter::ImageWriter(std::size_t workers, std::size_t queue_depth)
+    : depth(std::max<std::size_t>(queue_depth, 1)) {
+    workers = std::max<std::size_t>(workers, 1);
+
+    threads.reserve(workers);
+    for (std::size_t i = 0; i < workers; ++i) {
+        threads.emplace_back([this] { worker_loop(); });
+    }
+}
+
+ImageWriter::~ImageWriter() {
+    {
+        const std::lock_guard lk(mtx);
+        stopping = true;
+    }
+    work_cv.notify_all();
+
+    for (auto &t : threads) {
+        t.join();
+    }
+}
+
+void ImageWriter::write(AVFramePtr frame, std::string path) {
+    {
+        std::unique_lock lk(mtx);
+        space_cv.wait(lk, [this] { return jobs.size() < depth; });
+        jobs.push_back({std::move(frame), std::move(path)});
+    }
+    work_cv.notify_one();
+}
+
+void ImageWriter::finish() {
+    std::unique_lock lk(mtx);
+    idle_cv.wait(lk, [this] { return jobs.empty() && busy == 0; });
+}
+
+std::uint64_t ImageWriter::written() const {
+    const std::lock_guard lk(mtx);
+    return written_;
+}
+
+std::uint64_t ImageWriter::failed() const {
+    const std::lock_guard lk(mtx);
+    return failed_;
+}
+
+void ImageWriter::encode_png(const AVFrame *f, const std::string &path) {
+    static const AVCodec *png = avcodec_find_encoder(AV_CODEC_ID_PNG);
+    if (!png) {
+        throw std::runtime_error("No PNG encoder available.");
+    }
+
+    // Sizes differ between files, so every image gets its own short lived encoder
+    std::unique_ptr<AVCodecContext, void (*)(AVCodecContext *)> ctx{
+        avcodec_alloc_context3(png), [](AVCodecContext *c) { avcodec_free_context(&c); }};
+    AVPacketPtr pkt{av_packet_alloc()};
+    if (!ctx || !pkt) {
+        throw std::runtime_error("Failed to allocate encoder context/packet.");
+    }
+
+    ctx->width = f->width;
+    ctx->height = f->height;
+    ctx->pix_fmt = static_cast<AVPixelFormat>(f->format);
+    ctx->time_base = AVRational{1, 1};
+
+    int ret = avcodec_open2(ctx.get(), png, nullptr);
+    if (ret >= 0) {
+        ret = avcodec_send_frame(ctx.get(), f);
+    }
+    if (ret >= 0) {
+        ret = avcodec_receive_packet(ctx.get(), pkt.get());
+    }
+    if (ret < 0) {
+        throw DecoderError(DecoderErrorDesc::FAILURE, ret);
+    }
+
+    std::ofstream os(path, std::ios::binary | std::ios::trunc);
+    os.write(reinterpret_cast<const char *>(pkt->data), pkt->size);
+    if (!os) {
+        throw std::runtime_error("Failed to write " + path);
+    }
+}
+
+void ImageWriter::worker_loop() {
+    std::unique_lock lk(mtx);
+
+    while (true) {
+        work_cv.wait(lk, [this] { return stopping || !jobs.empty(); });
+        if (jobs.empty()) {
+            return;
+        }
+
+        auto job = std::move(jobs.front());
+        jobs.pop_front();
+        busy += 1;
+        lk.unlock();
+        space_cv.notify_one();
+
+        bool ok = true;
+        try {
+            encode_png(job.frame.get(), job.path);
+        } catch (const DecoderError &e) {
+            Log(Log::ERROR) << "Failed to encode " << job.path << ": " << e.error_string();
+            ok = false;
+        } catch (const std::exception &e) {
+            Log(Log::ERROR) << "Failed to encode " << job.path << ": " << e.what();
+            ok = false;
+        }
+        job.frame.reset();
+
+        lk.lock();
+        busy -= 1;
+        (ok ? written_ : failed_) += 1;
+        if (jobs.empty() && busy == 0) {
+            idle_cv.notify_all();
+        }
+    }
+}
+}  // namespace splayer
@@ -0,0 +1,82 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef IMAGE_WRITER_H_
+#define IMAGE_WRITER_H_
+
+#include <splayer/codec/decode/av_ptr.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace splayer {
+// Encodes RGB24 frames to PNG files on its own threads, so decoding never waits on compression or
+// the disk. The queue in front of the workers is bounded; a full queue blocks `write`.
+class ImageWriter final {
+public:
+    ImageWriter(std::size_t workers, std::size_t queue_depth);
+    ImageWriter(const ImageWriter &) = delete;
+    ImageWriter &operator=(const ImageWriter &) = delete;
+    // Writes whatever is still queued before returning.
+    ~ImageWriter();
+
+    // Takes ownership of `frame`, which nothing else may reference any more. May be called from
+    // any number of threads.
+    void write(AVFramePtr frame, std::string path);
+    // Returns once every image queued so far is written.
+    void finish();
+
+    std::uint64_t written() const;
+    std::uint64_t failed() const;
+
+private:
+    struct Job {
+        AVFramePtr frame;
+        std::string path;
+    };
+
+    void worker_loop();
+    static void encode_png(const AVFrame *f, const std::string &path);
+
+    const std::size_t depth;
+
+    mutable std::mutex mtx;
+    std::condition_variable work_cv;
+    std::condition_variable space_cv;
+    std::condition_variable idle_cv;
+    std::deque<Job> jobs;
+    std::size_t busy{};
+    std::uint64_t written_{};
+    std::uint64_t failed_{};
+    bool stopping{false};
+
+    std::vector<std::thread> threads;
+};
+}  // namespace splayer
+
+#endif /* IMAGE_WRITER_H_ */
@@ -0,0 +1,311 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "thumbnailer.h"
+
+#include "image_writer.h"
+
+#include <splayer/bench/bench.h>
+#include <splayer/util/pf_wrapper.h>
+#include <splayer/util/thread_pool.h>
+#include <splayer/util/utils.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+using namespace utils;
+
+namespace splayer {
+namespace {
+using thumb_clock = std::chrono::steady_clock;
+
+// Finished images waiting per writer thread before decoding stalls on them
+constexpr std::size_t WRITER_QUEUE_PER_THREAD = 8;
+
+std::int64_t elapsed_ns(thumb_clock::time_point beg) noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(thumb_clock::now() - beg).count();
+}
+
+class ThumbExtractor final {
+public:
+    ThumbExtractor(std::size_t index, const ThumbOptions &opts, ImageWriter &out)
+        : options(opts),
+          writer(out),
+          url(opts.inputs[index]),
+          // Inputs from different directories can share a stem, the index keeps their images apart
+          stem(std::filesystem::path(url).stem().string() + "_" + std::to_string(index)) {
+
+        // Inputs are already spread over the cores, codec threads would only compete with them
+        dec = open_decoder(url, opts.decoder, [](Decoder &d) {
+                  d.set_threading({1, ThreadType::BOTH, false});
+                  d.set_cnvt_target(CnvtTarget::RGB24);
+              }).decoder;
+
+        const auto [clip_w, clip_h] = dec->clip_dims();
+        const auto [w, h] = FrameConverter::fit_size(clip_w, clip_h, opts.width, opts.height);
+        dec->set_cnvt_size(w, h);
+        // Every thumbnail comes from a keyframe, nothing in between has to be decoded
+        dec->set_quality(DecodeQuality::KEYFRAMES_ONLY);
+
+        if (!pkt || !frame) {
+            throw std::runtime_error("Failed to allocate packet/frame.");
+        }
+    }
+
+    // Returns the number of images queued for writing
+    std::size_t run() {
+        const auto limit =
+            (options.max_per_file > 0 ? options.max_per_file
+                                      : std::numeric_limits<std::size_t>::max());
+
+        if (options.mode == ThumbMode::KEYFRAMES) {
+            while (count < limit && next_keyframe()) {
+                emit();
+            }
+
+            return count;
+        }
+
+        const double duration = dec->clip_duration();
+        if (!(duration > 0.0)) {
+            SPLAYER_LOG(INFO) << "Duration of " << url << " unknown, reading through it for "
+                              << "keyframes " << options.interval_s << "s apart instead.";
+            return run_spaced(limit);
+        }
+
+        std::int64_t last_pts{AV_NOPTS_VALUE};
+
+        for (std::size_t k = 0; count < limit; ++k) {
+            const double t = static_cast<double>(k) * options.interval_s;
+            if (k > 0) {
+                if (t >= duration) {
+                    break;
+                }
+
+                dec->seek(t, SeekMode::KEYFRAME);
+                draining = false;
+            }
+
+            if (!next_keyframe()) {
+                break;
+            }
+
+            // Points closer together than the keyframes land on the same one again
+            const auto pts = frame->best_effort_timestamp;
+            if (pts != AV_NOPTS_VALUE && last_pts != AV_NOPTS_VALUE && pts <= last_pts) {
+                av_frame_unref(frame.get());
+                continue;
+            }
+
+            last_pts = pts;
+            emit();
+        }
+
+        return count;
+    }
+
+private:
+    // Interval mode without seeking, for clips whose duration isn't known and so can't be split
+    // into points up front. Untimed keyframes are all kept.
+    std::size_t run_spaced(std::size_t limit) {
+        const double tb = av_q2d(dec->clip_time_base());
+        double next_t = -std::numeric_limits<double>::infinity();
+
+        while (count < limit && next_keyframe()) {
+            if (const auto pts = frame->best_effort_timestamp; pts != AV_NOPTS_VALUE) {
+                const double t = static_cast<double>(pts) * tb;
+                if (t < next_t) {
+                    av_frame_unref(frame.get());
+                    continue;
+                }
+
+                next_t = t + options.interval_s;
+            }
+
+            emit();
+        }
+
+        return count;
+    }
+
+    bool next_keyframe() {
+        while (!dec->receive_frame(frame.get())) {
+            if (draining) {
+                return false;
+            }
+
+            if (dec->read_packet(pkt.get())) {
+                dec->send_packet(pkt.get());
+                av_packet_unref(pkt.get());
+            } else {
+                dec->send_packet(nullptr);
+                draining = true;
+            }
+        }
+
+        return true;
+    }
+
+    // Converts the decoded frame and hands a copy of it to the writer, the pooled frame goes
+    // straight back to the converter.
+    void emit() {
+        const auto rgb = dec->convert_frame(frame.get());
+        av_frame_unref(frame.get());
+        if (!rgb) {
+            Log(Log::ERROR) << "Every pooled frame is still held by a consumer.";
+            throw DecoderError(DecoderErrorDesc::FAILURE);
+        }
+
+        AVFramePtr copy{av_frame_alloc()};
+        if (!copy) {
+            throw std::runtime_error("Failed to allocate frame.");
+        }
+
+        copy->format = rgb->format;
+        copy->width = rgb->width;
+        copy->height = rgb->height;
+
+        int ret = av_frame_get_buffer(copy.get(), 0);
+        if (ret >= 0) {
+            ret = av_frame_copy(copy.get(), rgb.get());
+        }
+        if (ret < 0) {
+            throw DecoderError(DecoderErrorDesc::FAILURE, ret);
+        }
+
+        std::array<char, 16> suffix;
+        std::snprintf(suffix.data(), suffix.size(), "_%04zu.png", count);
+        const auto path = std::filesystem::path(options.out_dir) / (stem + suffix.data());
+
+        writer.write(std::move(copy), path.string());
+        count += 1;
+    }
+
+    const ThumbOptions &options;
+    ImageWriter &writer;
+    const std::string &url;
+    const std::string stem;
+
+    std::unique_ptr<Decoder> dec;
+    AVPacketPtr pkt{av_packet_alloc()};
+    AVFramePtr frame{av_frame_alloc()};
+    bool draining{false};
+    std::size_t count{};
+};
+}  // namespace
+
+int run_thumbnails(const ThumbOptions &opts) {
+    if (opts.inputs.empty() || opts.interval_s <= 0.0 || opts.width < 2 || opts.height < 2) {
+        Log(Log::ERROR) << "Thumbnails need at least one input, an interval and a size.";
+        return -1;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(opts.out_dir, ec);
+    if (ec) {
+        Log(Log::ERROR) << "Failed to create " << opts.out_dir << ": " << ec.message();
+        return -1;
+    }
+
+    std::size_t jobs = (opts.jobs > 0 ? opts.jobs : std::thread::hardware_concurrency());
+    jobs = std::clamp<std::size_t>(jobs, 1, opts.inputs.size());
+    const std::size_t writers = std::max<std::size_t>(opts.writers, 1);
+
+    BenchReport r;
+    r.url = (opts.inputs.size() == 1 ? opts.inputs.front()
+                                     : std::to_string(opts.inputs.size()) + " files");
+    std::ostringstream desc;
+    desc << jobs << " decode jobs, " << writers << " png writers, " << opts.width << "x"
+         << opts.height << ", ";
+    if (opts.mode == ThumbMode::KEYFRAMES) {
+        desc << "every keyframe";
+    } else {
+        desc << "one per " << opts.interval_s << "s";
+    }
+    r.decoder = desc.str();
+
+    std::atomic<std::size_t> thumbs{};
+    std::atomic<std::size_t> failed_files{};
+    std::size_t failed_writes{};
+
+    const auto cpu_beg = process_cputime_ns();
+    const auto wall_beg = thumb_clock::now();
+
+    {
+        ImageWriter writer(writers, writers * WRITER_QUEUE_PER_THREAD);
+        // The calling thread decodes as well
+        ThreadPool pool(jobs - 1);
+
+        pool.run(opts.inputs.size(), [&](std::size_t i) {
+            const auto &url = opts.inputs[i];
+
+            try {
+                ThumbExtractor extractor(i, opts, writer);
+                thumbs += extractor.run();
+            } catch (const DecoderError &e) {
+                Log(Log::ERROR) << "Failed to extract thumbnails from " << url << ": "
+                                << e.error_string();
+                failed_files += 1;
+            } catch (const std::exception &e) {
+                Log(Log::ERROR) << "Failed to extract thumbnails from " << url << ": "
+                                << e.what();
+                failed_files += 1;
+            }
+        });
+
+        writer.finish();
+        r.metrics.emplace_back("images written", static_cast<double>(writer.written()));
+        failed_writes = writer.failed();
+        r.metrics.emplace_back("failed writes", static_cast<double>(failed_writes));
+    }
+
+    r.frames = thumbs;
+    r.wall_s = static_cast<double>(elapsed_ns(wall_beg)) / 1e9;
+    r.cpu_s = static_cast<double>(process_cputime_ns() - cpu_beg) / 1e9;
+    r.peak_rss_bytes = peak_rss_bytes();
+
+    const auto files = opts.inputs.size() - failed_files;
+    r.metrics.emplace_back("files", static_cast<double>(files));
+    r.metrics.emplace_back("failed files", static_cast<double>(failed_files));
+    r.metrics.emplace_back("files/s", r.wall_s > 0.0 ? files / r.wall_s : 0.0);
+    r.metrics.emplace_back("images/s", r.fps());
+
+    print_report(r, std::cout);
+
+    if (!opts.json_path.empty() && !write_report_json(r, opts.json_path)) {
+        Log(Log::ERROR) << "Failed to write thumbnail report to " << opts.json_path;
+        return -1;
+    }
+
+    return (failed_files > 0 || failed_writes > 0 ? -1 : 0);
+}
+}  // namespace splayer
@@ -0,0 +1,69 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef THUMBNAILER_H_
+#define THUMBNAILER_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <splayer/codec/decode/decoder_factory.h>
+
+namespace splayer {
+enum class ThumbMode {
+    // One image every `interval_s`, taken from the keyframe at or before each point. Clips of
+    // unknown duration are read through instead, keeping keyframes at least `interval_s` apart.
+    INTERVAL,
+    // Every keyframe of the clip
+    KEYFRAMES
+};
+
+struct ThumbOptions {
+    std::vector<std::string> inputs;
+    // Images are written as `<out_dir>/<input stem>_<input index>_<n>.png`
+    std::string out_dir{"."};
+    ThumbMode mode{ThumbMode::INTERVAL};
+    double interval_s{10.0};
+    // Images per input, 0 for no limit
+    std::size_t max_per_file{0};
+    // Box every image is fit into, keeping the aspect ratio
+    int width{320};
+    int height{180};
+    // Inputs decoded at once, 0 picks one per core
+    std::size_t jobs{0};
+    // Threads encoding and writing images
+    std::size_t writers{2};
+    DecoderPreference decoder{DecoderPreference::SOFTWARE};
+    // Also write the report as JSON to this path when non-empty.
+    std::string json_path;
+};
+
+// Extracts thumbnails from every input without a window. Inputs are decoded in parallel, each by a
+// single threaded decoder that seeks from keyframe to keyframe and only decodes those, scaling
+// them straight to the thumbnail size; PNG encoding happens on a separate writer pool. Prints a
+// `BenchReport` with the files and images per second. Returns the process exit code, non-zero if
+// any input or image failed.
+int run_thumbnails(const ThumbOptions &opts);
+}  // namespace splayer
+
+#endif /* THUMBNAILER_H_ */
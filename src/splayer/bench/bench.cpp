@@ -0,0 +1,1211 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.h"
+
+#include <GL/glew.h>
+#include <splayer/codec/convert/yuv_rgb.h>
+#include <splayer/display/gl_texture.h>
+#include <splayer/pipeline/frame_scheduler.h>
+#include <splayer/pipeline/pipeline.h>
+#include <splayer/util/alloc_counter.h>
+#include <splayer/util/memory_budget.h>
+#include <splayer/util/profiler.h>
+#include <splayer/util/utils.h>
+#include <splayer/window/window.h>
+
+extern "C" {
+#include <libswscale/swscale.h>
+}
+
+#include <algorithm>
+#include <cstdlib>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+using namespace utils;
+
+namespace splayer {
+namespace {
+using bench_clock = std::chrono::steady_clock;
+
+std::int64_t elapsed_ns(bench_clock::time_point beg) noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - beg).count();
+}
+
+std::string threading_label(const DecodeThreading &t) {
+    std::string s = (t.threads > 0 ? std::to_string(t.threads) : std::string{"auto"});
+    s += std::string{" "} + thread_type_name(t.type);
+    return s + (t.low_delay ? " low-delay" : "");
+}
+
+// Uploads timed per configuration of the upload bench, after a few untimed ones
+constexpr int UPLOAD_BENCH_ITERATIONS = 120;
+constexpr int UPLOAD_BENCH_WARMUP = 8;
+
+// Frames decoded by the allocation check, once to warm up and once counted
+constexpr std::size_t ALLOC_BENCH_FRAMES = 1000;
+// Frames popped from the pipeline before the allocation check starts counting, enough to cycle
+// every pool and queue of it
+constexpr std::size_t ALLOC_BENCH_PIPELINE_WARMUP = 100;
+
+// The scheduler check plays this much of a 24 fps stream on a 60 Hz display
+constexpr int SCHED_BENCH_FPS = 24;
+constexpr int SCHED_BENCH_HZ = 60;
+constexpr int SCHED_BENCH_SECONDS = 10;
+// The stalling run withholds frames for this many refreshes once per second
+constexpr int SCHED_BENCH_STALL_REFRESHES = 6;
+
+// Resident memory a pass of the leak check may add once the first one warmed everything up
+constexpr std::int64_t LEAK_TOLERANCE_BYTES = 256 * 1024;
+
+constexpr int CNVT_BENCH_WIDTH = 3840;
+constexpr int CNVT_BENCH_HEIGHT = 2160;
+constexpr int CNVT_BENCH_ITERATIONS = 10;
+
+struct SyntheticYuv {
+    std::array<std::vector<std::uint8_t>, 3> planes;
+    YuvImage img;
+};
+
+// Smooth gradients with some noise on top, so neither the clamps nor the chroma are trivial
+SyntheticYuv make_synthetic(YuvLayout layout, int w, int h) {
+    SyntheticYuv s;
+    const int bps = (layout == YuvLayout::P010 ? 2 : 1);
+    const int cw = (w + 1) / 2;
+    const int ch = (h + 1) / 2;
+    std::uint32_t seed = 0x9e3779b9;
+
+    const auto sample = [&](int a, int b) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return static_cast<std::uint8_t>((a + b + static_cast<int>(seed & 0x1f)) & 0xff);
+    };
+
+    const auto fill = [&](std::vector<std::uint8_t> &plane, int pw, int ph, int stride, int comps,
+                          int phase) {
+        plane.resize(static_cast<std::size_t>(stride) * static_cast<std::size_t>(ph));
+        for (int yy = 0; yy < ph; ++yy) {
+            for (int xx = 0; xx < pw * comps; ++xx) {
+                auto *p = &plane[static_cast<std::size_t>(yy * stride + xx * bps)];
+                p[bps - 1] = sample(xx * 255 / (pw * comps), yy * 255 / ph + phase);
+                if (bps == 2) {
+                    p[0] = static_cast<std::uint8_t>(p[1] & 0xc0);
+                }
+            }
+        }
+    };
+
+    s.img.width = w;
+    s.img.height = h;
+    s.img.layout = layout;
+    s.img.linesize = {w * bps, 0, 0};
+    fill(s.planes[0], w, h, w * bps, 1, 0);
+
+    if (layout == YuvLayout::YUV420P) {
+        s.img.linesize[1] = s.img.linesize[2] = cw;
+        fill(s.planes[1], cw, ch, cw, 1, 64);
+        fill(s.planes[2], cw, ch, cw, 1, 128);
+    } else {
+        s.img.linesize[1] = 2 * cw * bps;
+        fill(s.planes[1], cw, ch, 2 * cw * bps, 2, 64);
+    }
+
+    for (std::size_t i = 0; i < s.planes.size(); ++i) {
+        s.img.data[i] = (s.planes[i].empty() ? nullptr : s.planes[i].data());
+    }
+
+    return s;
+}
+
+AVPixelFormat av_format_of(YuvLayout l) noexcept {
+    switch (l) {
+        case YuvLayout::YUV420P:
+            return AV_PIX_FMT_YUV420P;
+        case YuvLayout::NV12:
+            return AV_PIX_FMT_NV12;
+        case YuvLayout::P010:
+            return AV_PIX_FMT_P010LE;
+    }
+
+    return AV_PIX_FMT_NONE;
+}
+
+AVPixelFormat av_format_of(RgbLayout l) noexcept {
+    switch (l) {
+        case RgbLayout::RGB24:
+            return AV_PIX_FMT_RGB24;
+        case RgbLayout::RGBA:
+            return AV_PIX_FMT_RGBA;
+        case RgbLayout::BGRA:
+            return AV_PIX_FMT_BGRA;
+    }
+
+    return AV_PIX_FMT_NONE;
+}
+
+template <typename F>
+double mean_ms(F &&f, int iterations) {
+    const auto beg = bench_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        f();
+    }
+
+    return static_cast<double>(elapsed_ns(beg)) / 1e6 / iterations;
+}
+
+// Pops up to `count` frames from a running pipeline, returns fewer when the stream ends first.
+std::size_t pop_frames(Pipeline &pipeline, std::size_t count) {
+    std::size_t n{};
+    while (n < count && !pipeline.finished()) {
+        if (pipeline.pop_frame()) {
+            n += 1;
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    return n;
+}
+
+// Frames one `1 / fps` apart in a time base of `1 / fps`, all of them ready right away unless
+// `stalled` is set.
+class SyntheticSource final : public FrameSource {
+public:
+    explicit SyntheticSource(std::int64_t count) : total(count) {}
+
+    PooledFramePtr pop_frame() override {
+        if (!peek_frame()) {
+            return {};
+        }
+
+        next_pts += 1;
+        return std::move(front);
+    }
+
+    const AVFrame *peek_frame() override {
+        if (!front && !stalled && next_pts < total) {
+            front = pool.acquire();
+            if (front) {
+                front->pts = front->best_effort_timestamp = next_pts;
+            }
+        }
+
+        return front.get();
+    }
+
+    bool finished() const override { return !front && next_pts >= total; }
+
+    bool stalled{false};
+
+private:
+    FramePool pool{2, FramePool::Mode::REFERENCE};
+    PooledFramePtr front;
+    std::int64_t next_pts{};
+    std::int64_t total;
+};
+
+// Drives `sched` from a simulated display clock until `src` runs dry, calling `on_refresh` with
+// the refresh index before each one.
+template <typename F>
+FrameScheduler::Stats play_synthetic(SyntheticSource &src, F &&on_refresh) {
+    FrameScheduler sched{src, AVRational{1, SCHED_BENCH_FPS}, SCHED_BENCH_FPS};
+    const auto refresh = std::chrono::nanoseconds(1'000'000'000 / SCHED_BENCH_HZ);
+
+    for (std::int64_t i = 0; !src.finished(); ++i) {
+        on_refresh(i);
+        sched.next_frame(FrameScheduler::clock::time_point{} + i * refresh);
+    }
+
+    return sched.stats();
+}
+
+constexpr int SEEK_SAMPLES = 16;
+
+// Seeks to `seconds` and decodes up to the frame the seek lands on, returns the time it took.
+std::int64_t time_seek(Decoder &dec, AVPacket *pkt, AVFrame *frame, double seconds, SeekMode mode) {
+    const auto beg = bench_clock::now();
+    dec.seek(seconds, mode);
+
+    while (!dec.receive_frame(frame)) {
+        const bool eof = !dec.read_packet(pkt);
+        dec.send_packet(eof ? nullptr : pkt);
+        av_packet_unref(pkt);
+
+        if (eof) {
+            dec.receive_frame(frame);
+            break;
+        }
+    }
+
+    const auto ns = elapsed_ns(beg);
+    av_frame_unref(frame);
+    return ns;
+}
+
+// Seeks back and forth across the clip. The targets are visited out of order so that consecutive
+// seeks never just continue decoding forward, and are far enough apart that one seek does not
+// index the area the next one lands in.
+LatencySeries bench_seeks(
+    Decoder &dec, AVPacket *pkt, AVFrame *frame, SeekMode mode, std::string_view label) {
+    LatencySeries s{std::string{"seek "} + (mode == SeekMode::EXACT ? "exact " : "key ") +
+                        std::string{label},
+        SEEK_SAMPLES};
+
+    const auto duration = dec.clip_duration();
+    if (duration <= 0.0) {
+        return s;
+    }
+
+    for (int i = 0; i < SEEK_SAMPLES; ++i) {
+        const auto slot = (i * 7) % SEEK_SAMPLES;
+        const auto seconds = duration * (slot + 0.5) / SEEK_SAMPLES;
+        s.add(time_seek(dec, pkt, frame, seconds, mode));
+    }
+
+    return s;
+}
+
+void write_json_string(std::ostream &os, std::string_view s) {
+    os << '"';
+    for (const char c : s) {
+        if (c == '"' || c == '\\') {
+            os << '\\';
+        }
+
+        os << c;
+    }
+    os << '"';
+}
+
+void write_json_summary(std::ostream &os, const LatencySeries::Summary &s) {
+    os << "{\"count\": " << s.count << ", \"mean_us\": " << s.mean_us
+       << ", \"p50_us\": " << s.p50_us << ", \"p99_us\": " << s.p99_us
+       << ", \"max_us\": " << s.max_us << '}';
+}
+}  // namespace
+
+LatencySeries::Summary LatencySeries::summarize() const {
+    if (samples.empty()) {
+        return {};
+    }
+
+    auto sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+
+    const auto to_us = [](std::int64_t ns) { return static_cast<double>(ns) / 1000.0; };
+    const auto percentile = [&](double q) {
+        const auto idx = static_cast<std::size_t>(q * static_cast<double>(sorted.size() - 1) + 0.5);
+        return to_us(sorted[std::min(idx, sorted.size() - 1)]);
+    };
+
+    double total{};
+    for (const auto ns : sorted) {
+        total += static_cast<double>(ns);
+    }
+
+    return {sorted.size(), total / static_cast<double>(sorted.size()) / 1000.0, percentile(0.50),
+        percentile(0.99), to_us(sorted.back())};
+}
+
+int run_bench(const BenchOptions &opts) {
+    BenchReport r;
+    r.url = opts.url;
+
+    constexpr std::size_t EXPECTED_SAMPLES = 1 << 14;
+    LatencySeries demux{"demux", EXPECTED_SAMPLES};
+    LatencySeries decode{"decode", EXPECTED_SAMPLES};
+    LatencySeries convert{"convert", EXPECTED_SAMPLES};
+    std::vector<LatencySeries> seeks;
+
+    try {
+        const auto setup = [&](Decoder &d) {
+            d.set_cnvt_target(CnvtTarget::RGB24);
+            d.set_cnvt_slices(opts.cnvt_slices);
+            d.set_threading(opts.threading);
+            d.set_probe_cache(opts.probe_cache);
+            d.set_input_io(opts.input_io, opts.input_io_cfg);
+        };
+
+        AVPacketPtr pkt{av_packet_alloc()};
+        AVFramePtr frame{av_frame_alloc()};
+        if (!pkt || !frame) {
+            throw std::runtime_error("Failed to allocate packet/frame.");
+        }
+
+        const auto cpu_beg = process_cputime_ns();
+        const auto wall_beg = bench_clock::now();
+
+        // Includes the trial decode when hardware decoding is tried
+        auto [dec, choice] = open_decoder(opts.url, opts.decoder, setup);
+        r.open_ms = static_cast<double>(elapsed_ns(wall_beg)) / 1e6;
+        r.decoder = dec->name() + " decoder (" + choice.reason + "), " +
+                    threading_label(dec->active_threading()) + " threads, " +
+                    std::to_string(opts.cnvt_slices) + " cnvt slices, " +
+                    input_io_name(opts.input_io) + " input";
+        if (opts.probe_cache) {
+            r.metrics.emplace_back("probe cache hit", dec->probe_cache_hit() ? 1.0 : 0.0);
+        }
+
+        bool eof{false};
+        while (!eof) {
+            auto t = bench_clock::now();
+            eof = !dec->read_packet(pkt.get());
+            if (!eof) {
+                demux.add(elapsed_ns(t));
+            }
+
+            // One decode sample covers sending a packet and draining every frame it produced.
+            t = bench_clock::now();
+            dec->send_packet(eof ? nullptr : pkt.get());
+            av_packet_unref(pkt.get());
+            std::int64_t decode_ns = elapsed_ns(t);
+
+            while (true) {
+                t = bench_clock::now();
+                const bool got = dec->receive_frame(frame.get());
+                decode_ns += elapsed_ns(t);
+
+                if (!got) {
+                    break;
+                }
+
+                t = bench_clock::now();
+                const auto out = dec->convert_frame(frame.get());
+                convert.add(elapsed_ns(t));
+
+                if (r.frames == 0) {
+                    r.first_frame_ms = static_cast<double>(elapsed_ns(wall_beg)) / 1e6;
+                }
+
+                r.frames += 1;
+            }
+
+            decode.add(decode_ns);
+        }
+
+        r.wall_s = static_cast<double>(elapsed_ns(wall_beg)) / 1e9;
+        r.cpu_s = static_cast<double>(process_cputime_ns() - cpu_beg) / 1e9;
+
+        for (auto &m : dec->input_io_stats()) {
+            r.metrics.push_back(std::move(m));
+        }
+
+        // The playthrough indexed every keyframe, fresh decoders have to ask the demuxer
+        for (const auto mode : {SeekMode::KEYFRAME, SeekMode::EXACT}) {
+            seeks.push_back(bench_seeks(*dec, pkt.get(), frame.get(), mode, "(indexed)"));
+        }
+
+        for (const auto mode : {SeekMode::KEYFRAME, SeekMode::EXACT}) {
+            auto cold = open_decoder(opts.url, opts.decoder, setup).decoder;
+            seeks.push_back(bench_seeks(*cold, pkt.get(), frame.get(), mode, "(demuxer)"));
+        }
+
+        r.peak_rss_bytes = peak_rss_bytes();
+        r.metrics.emplace_back("peak frame memory MiB",
+                               static_cast<double>(MemoryBudget::usage().peak) / (1 << 20));
+    } catch (const DecoderError &e) {
+        Log(Log::ERROR) << "Benchmark failed: " << e.error_string();
+        return -1;
+    } catch (const std::exception &e) {
+        Log(Log::ERROR) << "Benchmark failed: " << e.what();
+        return -1;
+    }
+
+    for (const auto *s : {&demux, &decode, &convert}) {
+        r.stages.emplace_back(s->name(), s->summarize());
+    }
+
+    for (const auto &s : seeks) {
+        r.stages.emplace_back(s.name(), s.summarize());
+    }
+
+    // With --profile the individual FFmpeg calls behind each stage are broken out as well
+    if (Profiler::enabled()) {
+        for (const auto &z : Profiler::summarize()) {
+            r.stages.emplace_back(
+                z.name, LatencySeries::Summary{z.count, z.mean_us, z.p50_us, z.p99_us, z.max_us});
+        }
+    }
+
+    print_report(r, std::cout);
+
+    if (!opts.json_path.empty() && !write_report_json(r, opts.json_path)) {
+        Log(Log::ERROR) << "Failed to write benchmark report to " << opts.json_path;
+        return -1;
+    }
+
+    return 0;
+}
+
+int run_cnvt_bench(const BenchOptions &opts) {
+    constexpr int w = CNVT_BENCH_WIDTH;
+    constexpr int h = CNVT_BENCH_HEIGHT;
+    // swscale assumes limited range BT.601 unless told otherwise
+    constexpr auto standard = graphics::ColorStandard::BT601;
+    constexpr auto range = graphics::ColorRange::LIMITED;
+
+    BenchReport r;
+    r.url = "synthetic " + std::to_string(w) + "x" + std::to_string(h);
+    r.decoder = "yuv_to_rgb, up to " + std::string(YuvToRgb::simd_name(YuvToRgb::detect_simd()));
+
+    const auto cpu_beg = process_cputime_ns();
+    const auto wall_beg = bench_clock::now();
+    bool all_exact = true;
+
+    for (const auto src_layout : {YuvLayout::YUV420P, YuvLayout::NV12, YuvLayout::P010}) {
+        const auto src = make_synthetic(src_layout, w, h);
+
+        for (const auto dst_layout : {RgbLayout::RGB24, RgbLayout::RGBA, RgbLayout::BGRA}) {
+            const int stride = w * (dst_layout == RgbLayout::RGB24 ? 3 : 4);
+            const auto size = static_cast<std::size_t>(stride) * h;
+            std::vector<std::uint8_t> ref(size), out(size);
+            const std::string conversion = std::string(YuvToRgb::layout_name(src_layout)) + "->" +
+                                           std::string(YuvToRgb::layout_name(dst_layout));
+            const std::string name = conversion + ' ';
+
+            YuvToRgb(standard, range, SimdLevel::SCALAR)
+                .convert(src.img, {ref.data(), stride, dst_layout});
+
+            for (int lv = 0; lv <= static_cast<int>(YuvToRgb::detect_simd()); ++lv) {
+                const auto level = static_cast<SimdLevel>(lv);
+                const YuvToRgb cnvt(standard, range, level);
+                const RgbImage dst{out.data(), stride, dst_layout};
+
+                const auto ms = mean_ms([&] { cnvt.convert(src.img, dst); }, CNVT_BENCH_ITERATIONS);
+                r.frames += CNVT_BENCH_ITERATIONS;
+                r.metrics.emplace_back(name + std::string(YuvToRgb::simd_name(level)) + " ms", ms);
+
+                if (level != SimdLevel::SCALAR) {
+                    const bool exact = (out == ref);
+                    all_exact = all_exact && exact;
+                    r.metrics.emplace_back(
+                        name + std::string(YuvToRgb::simd_name(level)) + " exact", exact);
+                }
+            }
+
+            SwsContext *sws = sws_getCachedContext(nullptr, w, h, av_format_of(src_layout), w, h,
+                av_format_of(dst_layout), SWS_BILINEAR, nullptr, nullptr, nullptr);
+            if (!sws) {
+                Log(Log::ERROR) << "swscale does not support " << conversion;
+                continue;
+            }
+
+            const std::array<std::uint8_t *, 4> dst_data{out.data()};
+            const std::array<int, 4> dst_stride{stride};
+            const auto ms = mean_ms(
+                [&] {
+                    sws_scale(sws, src.img.data.data(), src.img.linesize.data(), 0, h,
+                        dst_data.data(), dst_stride.data());
+                },
+                CNVT_BENCH_ITERATIONS);
+            sws_freeContext(sws);
+
+            int max_diff = 0;
+            for (std::size_t i = 0; i < size; ++i) {
+                max_diff = std::max(max_diff, std::abs(out[i] - ref[i]));
+            }
+
+            r.frames += CNVT_BENCH_ITERATIONS;
+            r.metrics.emplace_back(name + "swscale ms", ms);
+            r.metrics.emplace_back(name + "swscale max diff", max_diff);
+        }
+    }
+
+    r.wall_s = static_cast<double>(elapsed_ns(wall_beg)) / 1e9;
+    r.cpu_s = static_cast<double>(process_cputime_ns() - cpu_beg) / 1e9;
+    r.peak_rss_bytes = peak_rss_bytes();
+
+    print_report(r, std::cout);
+
+    if (!opts.json_path.empty() && !write_report_json(r, opts.json_path)) {
+        Log(Log::ERROR) << "Failed to write benchmark report to " << opts.json_path;
+        return -1;
+    }
+
+    if (!all_exact) {
+        Log(Log::ERROR) << "SIMD kernels are not bit exact with the scalar reference";
+        return -1;
+    }
+
+    return 0;
+}
+
+int run_io_bench(const BenchOptions &opts) {
+    BenchReport r;
+    r.url = opts.url;
+    r.decoder = std::string{"demux only, "} + (opts.cold_cache ? "cold" : "warm") + " page cache";
+
+    try {
+        AVPacketPtr pkt{av_packet_alloc()};
+        if (!pkt) {
+            throw std::runtime_error("Failed to allocate packet.");
+        }
+
+        const auto cpu_beg = process_cputime_ns();
+        const auto wall_beg = bench_clock::now();
+
+        struct Pass {
+            InputIoMode mode;
+            bool warmup;
+        };
+
+        // Warm runs get a first pass that only fills the page cache, cold ones evict the file
+        // before every pass so each mode has to go to the disk.
+        const auto path = local_path_of(opts.url).value_or(opts.url);
+        for (const auto [mode, warmup] :
+            {Pass{InputIoMode::DEFAULT, true}, Pass{InputIoMode::DEFAULT, false},
+                Pass{InputIoMode::MMAP, false}, Pass{InputIoMode::READAHEAD, false}}) {
+            if (warmup && opts.cold_cache) {
+                continue;
+            }
+
+            if (opts.cold_cache && !evict_file_cache(path)) {
+                throw std::runtime_error("Failed to evict " + path + " from the page cache.");
+            }
+
+            const auto io_beg = process_io_counters();
+            const auto mode_cpu_beg = process_cputime_ns();
+            const auto t = bench_clock::now();
+
+            auto dec = open_decoder(opts.url, DecoderPreference::SOFTWARE, [&](Decoder &d) {
+                d.set_input_io(mode, opts.input_io_cfg);
+            }).decoder;
+
+            // The slowest packet is the hitch playback would see
+            std::size_t packets{};
+            std::int64_t worst_ns{};
+            auto pkt_beg = bench_clock::now();
+            while (dec->read_packet(pkt.get())) {
+                worst_ns = std::max(worst_ns, elapsed_ns(pkt_beg));
+                av_packet_unref(pkt.get());
+                packets += 1;
+                pkt_beg = bench_clock::now();
+            }
+
+            const auto ms = static_cast<double>(elapsed_ns(t)) / 1e6;
+            const auto cpu_ms = static_cast<double>(process_cputime_ns() - mode_cpu_beg) / 1e6;
+            const auto io = process_io_counters();
+
+            r.frames = packets;
+            if (warmup) {
+                continue;
+            }
+
+            const std::string name = input_io_name(mode);
+            r.metrics.emplace_back(name + " demux ms", ms);
+            r.metrics.emplace_back(name + " cpu ms", cpu_ms);
+            r.metrics.emplace_back(name + " read syscalls",
+                static_cast<double>(io.read_syscalls - io_beg.read_syscalls));
+            r.metrics.emplace_back(name + " read MiB",
+                static_cast<double>(io.read_bytes - io_beg.read_bytes) / (1024.0 * 1024.0));
+            r.metrics.emplace_back(
+                name + " minor faults", static_cast<double>(io.minor_faults - io_beg.minor_faults));
+            r.metrics.emplace_back(
+                name + " major faults", static_cast<double>(io.major_faults - io_beg.major_faults));
+            r.metrics.emplace_back(name + " worst packet ms", static_cast<double>(worst_ns) / 1e6);
+
+            for (auto &m : dec->input_io_stats()) {
+                r.metrics.push_back(std::move(m));
+            }
+        }
+
+        r.wall_s = static_cast<double>(elapsed_ns(wall_beg)) / 1e9;
+        r.cpu_s = static_cast<double>(process_cputime_ns() - cpu_beg) / 1e9;
+        r.peak_rss_bytes = peak_rss_bytes();
+    } catch (const DecoderError &e) {
+        Log(Log::ERROR) << "Benchmark failed: " << e.error_string();
+        return -1;
+    } catch (const std::exception &e) {
+        Log(Log::ERROR) << "Benchmark failed: " << e.what();
+        return -1;
+    }
+
+    print_report(r, std::cout);
+
+    if (!opts.json_path.empty() && !write_report_json(r, opts.json_path)) {
+        Log(Log::ERROR) << "Failed to write benchmark report to " << opts.json_path;
+        return -1;
+    }
+
+    return 0;
+}
+
+int run_slice_bench(const BenchOptions &opts) {
+    constexpr int w = CNVT_BENCH_WIDTH;
+    constexpr int h = CNVT_BENCH_HEIGHT;
+    const auto max_slices = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, 32);
+
+    BenchReport r;
+    r.url = "synthetic " + std::to_string(w) + "x" + std::to_string(h) + " yuv420p->rgb24";
+    r.decoder = "1 to " + std::to_string(max_slices) + " slices";
+
+    AVFramePtr frame{av_frame_alloc()};
+    if (!frame) {
+        Log(Log::ERROR) << "Failed to allocate frame.";
+        return -1;
+    }
+
+    frame->format = AV_PIX_FMT_YUV420P;
+    frame->width = w;
+    frame->height = h;
+    if (av_frame_get_buffer(frame.get(), 0) < 0) {
+        Log(Log::ERROR) << "Failed to allocate frame buffer.";
+        return -1;
+    }
+
+    const auto src = make_synthetic(YuvLayout::YUV420P, w, h);
+    for (std::size_t p = 0; p < 3; ++p) {
+        const int rows = (p == 0 ? h : (h + 1) / 2);
+        for (int y = 0; y < rows; ++y) {
+            std::copy_n(src.img.data[p] + y * src.img.linesize[p], src.img.linesize[p],
+                frame->data[p] + y * frame->linesize[p]);
+        }
+    }
+
+    const auto cpu_beg = process_cputime_ns();
+    const auto wall_beg = bench_clock::now();
+
+    for (const bool native : {true, false}) {
+        FrameConverter cnvt(SWS_BILINEAR);
+        cnvt.set_target(CnvtTarget::RGB24);
+        cnvt.set_native_cnvt(native);
+
+        const std::string path = (native ? "native " : "swscale ");
+        double single_ms{};
+
+        for (std::size_t n = 1; n <= max_slices; ++n) {
+            cnvt.set_slices(n);
+            // Warms up the slice contexts and the output pool
+            cnvt.convert(frame.get());
+
+            const auto ms = mean_ms(
+                [&] {
+                    if (!cnvt.convert(frame.get())) {
+                        throw std::runtime_error("Conversion pool exhausted.");
+                    }
+                },
+                CNVT_BENCH_ITERATIONS);
+
+            single_ms = (n == 1 ? ms : single_ms);
+            r.frames += CNVT_BENCH_ITERATIONS;
+            r.metrics.emplace_back(path + std::to_string(n) + " slices ms", ms);
+            r.metrics.emplace_back(path + std::to_string(n) + " slices speedup", single_ms / ms);
+        }
+    }
+
+    r.wall_s = static_cast<double>(elapsed_ns(wall_beg)) / 1e9;
+    r.cpu_s = static_cast<double>(process_cputime_ns() - cpu_beg) / 1e9;
+    r.peak_rss_bytes = peak_rss_bytes();
+
+    print_report(r, std::cout);
+
+    if (!opts.json_path.empty() && !write_report_json(r, opts.json_path)) {
+        Log(Log::ERROR) << "Failed to write benchmark report to " << opts.json_path;
+        return -1;
+    }
+
+    return 0;
+}
+
+int run_thread_bench(const BenchOptions &opts) {
+    BenchReport r;
+    r.url = opts.url;
+
+    // Thread counts up to one per core, auto (0) being whatever libavcodec picks
+    const int cores = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1U));
+    std::vector<int> counts;
+    for (int n = 2; n < cores; n *= 2) {
+        counts.push_back(n);
+    }
+    counts.push_back(cores);
+    counts.push_back(0);
+
+    std::vector<DecodeThreading> configs{{1, ThreadType::BOTH, false}};
+    for (const auto type : {ThreadType::FRAME, ThreadType::SLICE, ThreadType::BOTH}) {
+        for (const int n : counts) {
+            configs.push_back({n, type, false});
+        }
+    }
+    for (const auto type : {ThreadType::SLICE, ThreadType::BOTH}) {
+        configs.push_back({0, type, true});
+    }
+
+    const auto cpu_beg = process_cputime_ns();
+    const auto wall_beg = bench_clock::now();
+
+    try {
+        AVPacketPtr pkt{av_packet_alloc()};
+        AVFramePtr frame{av_frame_alloc()};
+        if (!pkt || !frame) {
+            throw std::runtime_error("Failed to allocate packet/frame.");
+        }
+
+        for (const auto &cfg : configs) {
+            auto [dec, choice] = open_decoder(
+                opts.url, opts.decoder, [&](Decoder &d) { d.set_threading(cfg); });
+            if (r.decoder.empty()) {
+                r.decoder = dec->name() + " decoder (" + choice.reason + ")";
+            }
+
+            const auto label = threading_label(cfg);
+            LatencySeries decode{label, 1 << 14};
+
+            // Packets the decoder takes in before the first frame comes out
+            std::size_t delay{};
+            std::size_t frames{};
+            const auto t_beg = bench_clock::now();
+
+            bool eof{false};
+            while (!eof) {
+                eof = !dec->read_packet(pkt.get());
+
+                const auto t = bench_clock::now();
+                dec->send_packet(eof ? nullptr : pkt.get());
+                av_packet_unref(pkt.get());
+                while (dec->receive_frame(frame.get())) {
+                    av_frame_unref(frame.get());
+                    frames += 1;
+                }
+                decode.add(elapsed_ns(t));
+
+                delay += (frames == 0 && !eof ? 1 : 0);
+            }
+
+            const auto s = static_cast<double>(elapsed_ns(t_beg)) / 1e9;
+            r.frames += frames;
+            r.stages.emplace_back(label, decode.summarize());
+            r.metrics.emplace_back(label + " fps", s > 0.0 ? frames / s : 0.0);
+            r.metrics.emplace_back(label + " delay frames", static_cast<double>(delay));
+            // Configurations the codec can't honour collapse into another one, say which
+            SPLAYER_LOG(INFO) << "Threading " << label << " ran as "
+                              << threading_label(dec->active_threading());
+        }
+    } catch (const DecoderError &e) {
+        Log(Log::ERROR) << "Benchmark failed: " << e.error_string();
+        return -1;
+    } catch (const std::exception &e) {
+        Log(Log::ERROR) << "Benchmark failed: " << e.what();
+        return -1;
+    }
+
+    r.wall_s = static_cast<double>(elapsed_ns(wall_beg)) / 1e9;
+    r.cpu_s = static_cast<double>(process_cputime_ns() - cpu_beg) / 1e9;
+    r.peak_rss_bytes = peak_rss_bytes();
+
+    print_report(r, std::cout);
+
+    if (!opts.json_path.empty() && !write_report_json(r, opts.json_path)) {
+        Log(Log::ERROR) << "Failed to write benchmark report to " << opts.json_path;
+        return -1;
+    }
+
+    return 0;
+}
+
+int run_upload_bench(const BenchOptions &opts) {
+    constexpr int w = CNVT_BENCH_WIDTH;
+    constexpr int h = CNVT_BENCH_HEIGHT;
+    constexpr int stride = w * 3;
+
+    BenchReport r;
+    r.url = "synthetic " + std::to_string(w) + "x" + std::to_string(h) + " RGB24";
+
+    std::vector<std::uint8_t> pixels(static_cast<std::size_t>(stride) * h);
+    for (std::size_t i = 0; i < pixels.size(); ++i) {
+        pixels[i] = static_cast<std::uint8_t>(i * 7);
+    }
+
+    const auto cpu_beg = process_cputime_ns();
+    const auto wall_beg = bench_clock::now();
+
+    try {
+        // Hidden, so it runs without a display server on e.g. Mesa's llvmpipe through EGL
+        graphics::Window window;
+        window.create_window("upload bench", 64, 64, false);
+        r.decoder = reinterpret_cast<const char *>(glGetString(GL_RENDERER));
+
+        // Direct uploads first, then rings of two and three pixel buffers
+        for (const std::size_t ring : {std::size_t{0}, std::size_t{2}, std::size_t{3}}) {
+            const auto label = (ring == 0 ? std::string{"direct"}
+                                          : "pbo ring " + std::to_string(ring));
+            LatencySeries upload{label, UPLOAD_BENCH_ITERATIONS};
+
+            graphics::GlTexture tex{w, h};
+            if (ring > 0) {
+                tex.enable_streaming(ring);
+            }
+
+            for (int i = 0; i < UPLOAD_BENCH_WARMUP; ++i) {
+                tex.upload(pixels.data(), stride);
+            }
+            glFinish();
+
+            // Time on the calling thread is what a render loop loses per frame; the GPU side of
+            // the copies is only waited for at the end.
+            const auto beg = bench_clock::now();
+            for (int i = 0; i < UPLOAD_BENCH_ITERATIONS; ++i) {
+                const auto t = bench_clock::now();
+                tex.upload(pixels.data(), stride);
+                upload.add(elapsed_ns(t));
+            }
+            glFinish();
+            const auto s = static_cast<double>(elapsed_ns(beg)) / 1e9;
+
+            r.frames += UPLOAD_BENCH_ITERATIONS;
+            r.stages.emplace_back(label, upload.summarize());
+            r.metrics.emplace_back(label + " uploads/s", UPLOAD_BENCH_ITERATIONS / s);
+
+            if (const auto st = tex.stream_stats()) {
+                r.metrics.emplace_back(
+                    label + " fence waits", static_cast<double>(st->fence_waits));
+                r.metrics.emplace_back(
+                    label + " fence wait ms", static_cast<double>(st->fence_wait_ns) / 1e6);
+            }
+        }
+    } catch (const std::exception &e) {
+        Log(Log::ERROR) << "Benchmark failed: " << e.what();
+        return -1;
+    }
+
+    r.wall_s = static_cast<double>(elapsed_ns(wall_beg)) / 1e9;
+    r.cpu_s = static_cast<double>(process_cputime_ns() - cpu_beg) / 1e9;
+    r.peak_rss_bytes = peak_rss_bytes();
+
+    print_report(r, std::cout);
+
+    if (!opts.json_path.empty() && !write_report_json(r, opts.json_path)) {
+        Log(Log::ERROR) << "Failed to write benchmark report to " << opts.json_path;
+        return -1;
+    }
+
+    return 0;
+}
+
+int run_sched_bench(const BenchOptions &opts) {
+    BenchReport r;
+    r.url = "synthetic " + std::to_string(SCHED_BENCH_FPS) + " fps on " +
+            std::to_string(SCHED_BENCH_HZ) + " Hz";
+    r.decoder = "FrameScheduler";
+
+    constexpr std::int64_t frames = SCHED_BENCH_FPS * SCHED_BENCH_SECONDS;
+
+    const auto cpu_beg = process_cputime_ns();
+    const auto wall_beg = bench_clock::now();
+
+    // Every frame is ready before it's due, so the scheduler only ever holds for the cadence
+    SyntheticSource steady{frames};
+    const auto st = play_synthetic(steady, [](std::int64_t) {});
+
+    // Once a second the decoder falls behind for a few refreshes, each of those is a real miss
+    SyntheticSource stalling{frames};
+    const auto stalled = play_synthetic(stalling, [&](std::int64_t i) {
+        stalling.stalled = (i % SCHED_BENCH_HZ >= SCHED_BENCH_HZ - SCHED_BENCH_STALL_REFRESHES);
+    });
+
+    r.wall_s = static_cast<double>(elapsed_ns(wall_beg)) / 1e9;
+    r.cpu_s = static_cast<double>(process_cputime_ns() - cpu_beg) / 1e9;
+    r.peak_rss_bytes = peak_rss_bytes();
+    r.frames = st.presented + stalled.presented;
+
+    for (const auto &[label, s] : {std::pair{"steady", st}, std::pair{"stalling", stalled}}) {
+        const std::string l{label};
+        r.metrics.emplace_back(l + " presented", static_cast<double>(s.presented));
+        r.metrics.emplace_back(l + " dropped", static_cast<double>(s.dropped));
+        r.metrics.emplace_back(l + " repeated", static_cast<double>(s.repeated));
+        r.metrics.emplace_back(l + " late", static_cast<double>(s.late));
+    }
+
+    print_report(r, std::cout);
+
+    if (!opts.json_path.empty() && !write_report_json(r, opts.json_path)) {
+        Log(Log::ERROR) << "Failed to write benchmark report to " << opts.json_path;
+        return -1;
+    }
+
+    if (st.repeated > 0 || st.dropped > 0 || st.presented != frames) {
+        Log(Log::ERROR) << "Steady playback presented " << st.presented << " of " << frames
+                        << " frames, dropped " << st.dropped << " and counted " << st.repeated
+                        << " repeats.";
+        return -1;
+    }
+
+    if (stalled.repeated == 0) {
+        Log(Log::ERROR) << "Stalling playback counted no repeats.";
+        return -1;
+    }
+
+    return 0;
+}
+
+int run_alloc_bench(const BenchOptions &opts) {
+    BenchReport r;
+    r.url = opts.url;
+
+    std::uint64_t heap_allocs{};
+    std::uint64_t pipeline_heap_allocs{};
+    std::uint64_t buffer_allocs{};
+
+    const auto cpu_beg = process_cputime_ns();
+    const auto wall_beg = bench_clock::now();
+
+    try {
+        auto [dec, choice] = open_decoder(opts.url, opts.decoder, [&](Decoder &d) {
+            d.set_cnvt_slices(opts.cnvt_slices);
+            d.set_threading(opts.threading);
+            d.set_input_io(opts.input_io, opts.input_io_cfg);
+        });
+        r.decoder = dec->name() + " decoder (" + choice.reason + "), " +
+                    threading_label(dec->active_threading()) + " threads";
+
+        // The first run fills the pools, codec buffers and keyframe index
+        std::size_t frames{};
+        while (frames < ALLOC_BENCH_FRAMES && dec->decode_frame()) {
+            frames += 1;
+        }
+
+        dec->seek(0.0, SeekMode::KEYFRAME);
+
+        const auto heap_beg = heap_allocations();
+        const auto buffer_beg = dec->cnvt_buffer_allocations();
+
+        while (r.frames < frames && dec->decode_frame()) {
+            r.frames += 1;
+        }
+
+        heap_allocs = heap_allocations() - heap_beg;
+        buffer_allocs = dec->cnvt_buffer_allocations() - buffer_beg;
+
+        // The same frames once more through the demux, decode and conversion threads. Starting the
+        // pipeline allocates its threads, so counting starts after the first frames went through.
+        // Demux runs up to every queue's depth ahead of the frames popped here, and past the
+        // frames decoded above it would still be growing the keyframe index.
+        dec->seek(0.0, SeekMode::KEYFRAME);
+        Pipeline pipeline{*dec};
+        pipeline.start();
+
+        const Pipeline::Depths depths{};
+        const auto ahead = depths.packets + depths.decoded + depths.converted;
+        const auto counted_end = (frames < ALLOC_BENCH_FRAMES ? frames : frames - ahead);
+        const auto warm = pop_frames(pipeline, ALLOC_BENCH_PIPELINE_WARMUP);
+
+        const auto pipeline_heap_beg = heap_allocations();
+        const auto pipeline_buffer_beg = dec->cnvt_buffer_allocations();
+
+        if (counted_end > warm) {
+            r.frames += pop_frames(pipeline, counted_end - warm);
+        }
+
+        pipeline_heap_allocs = heap_allocations() - pipeline_heap_beg;
+        buffer_allocs += dec->cnvt_buffer_allocations() - pipeline_buffer_beg;
+
+        pipeline.stop();
+        if (pipeline.failed()) {
+            throw std::runtime_error("Pipeline failed");
+        }
+    } catch (const DecoderError &e) {
+        Log(Log::ERROR) << "Benchmark failed: " << e.error_string();
+        return -1;
+    } catch (const std::exception &e) {
+        Log(Log::ERROR) << "Benchmark failed: " << e.what();
+        return -1;
+    }
+
+    r.wall_s = static_cast<double>(elapsed_ns(wall_beg)) / 1e9;
+    r.cpu_s = static_cast<double>(process_cputime_ns() - cpu_beg) / 1e9;
+    r.peak_rss_bytes = peak_rss_bytes();
+    if (HEAP_ALLOCATIONS_COUNTED) {
+        r.metrics.emplace_back(
+            "operator new calls, calling thread", static_cast<double>(heap_allocs));
+        r.metrics.emplace_back(
+            "operator new calls, pipeline", static_cast<double>(pipeline_heap_allocs));
+    } else {
+        SPLAYER_LOG(INFO) << "operator new is not counted in this build, configure with "
+                          << "-DENABLE_ALLOC_COUNTER=ON to check it too.";
+    }
+    r.metrics.emplace_back("pool buffer allocations", static_cast<double>(buffer_allocs));
+
+    print_report(r, std::cout);
+
+    if (!opts.json_path.empty() && !write_report_json(r, opts.json_path)) {
+        Log(Log::ERROR) << "Failed to write benchmark report to " << opts.json_path;
+        return -1;
+    }
+
+    if (heap_allocs > 0 || pipeline_heap_allocs > 0 || buffer_allocs > 0) {
+        Log(Log::ERROR) << "Steady state decoding allocated " << heap_allocs << " times on the "
+                        << "calling thread and " << pipeline_heap_allocs << " times in the "
+                        << "pipeline through operator new, and " << buffer_allocs
+                        << " pooled buffers.";
+        return -1;
+    }
+
+    return 0;
+}
+
+int run_leak_bench(const BenchOptions &opts) {
+    BenchReport r;
+    r.url = opts.url;
+
+    const auto passes = std::max<std::size_t>(opts.leak_passes, 2);
+    std::vector<std::int64_t> rss;
+    rss.reserve(passes);
+
+    const auto cpu_beg = process_cputime_ns();
+    const auto wall_beg = bench_clock::now();
+
+    try {
+        auto [dec, choice] = open_decoder(opts.url, opts.decoder, [&](Decoder &d) {
+            d.set_threading(opts.threading);
+            d.set_input_io(opts.input_io, opts.input_io_cfg);
+        });
+        r.decoder = dec->name() + " decoder (" + choice.reason + "), " +
+                    threading_label(dec->active_threading()) + " threads, " +
+                    std::to_string(passes) + " passes";
+
+        for (std::size_t pass = 0; pass < passes; ++pass) {
+            // A fresh pipeline per pass, so its queues and pools are part of what's checked
+            Pipeline pipeline{*dec};
+            pipeline.start();
+
+            while (!pipeline.finished()) {
+                if (pipeline.pop_frame()) {
+                    r.frames += 1;
+                } else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            }
+
+            if (pipeline.failed()) {
+                throw std::runtime_error("Pipeline failed during pass " + std::to_string(pass));
+            }
+
+            pipeline.stop();
+            dec->seek(0.0, SeekMode::KEYFRAME);
+
+            rss.push_back(current_rss_bytes());
+            r.metrics.emplace_back("rss after pass " + std::to_string(pass + 1) + " MiB",
+                                   static_cast<double>(rss.back()) / (1 << 20));
+        }
+    } catch (const DecoderError &e) {
+        Log(Log::ERROR) << "Benchmark failed: " << e.error_string();
+        return -1;
+    } catch (const std::exception &e) {
+        Log(Log::ERROR) << "Benchmark failed: " << e.what();
+        return -1;
+    }
+
+    r.wall_s = static_cast<double>(elapsed_ns(wall_beg)) / 1e9;
+    r.cpu_s = static_cast<double>(process_cputime_ns() - cpu_beg) / 1e9;
+    r.peak_rss_bytes = peak_rss_bytes();
+
+    // The first pass allocates the pools, codec buffers and keyframe index, steady state is after
+    const auto growth = (rss.back() - rss.front()) / static_cast<std::int64_t>(passes - 1);
+    r.metrics.emplace_back("rss growth per pass KiB", static_cast<double>(growth) / 1024.0);
+
+    print_report(r, std::cout);
+
+    if (!opts.json_path.empty() && !write_report_json(r, opts.json_path)) {
+        Log(Log::ERROR) << "Failed to write benchmark report to " << opts.json_path;
+        return -1;
+    }
+
+    if (growth > LEAK_TOLERANCE_BYTES) {
+        Log(Log::ERROR) << "Resident memory grew by " << growth / 1024 << " KiB per pass.";
+        return -1;
+    }
+
+    return 0;
+}
+
+void print_report(const BenchReport &r, std::ostream &os) {
+    const auto flags = os.flags();
+
+    os << std::fixed << std::setprecision(2);
+    os << "bench: " << r.url << " (" << r.decoder << ")\n";
+    os << "  frames     " << r.frames << '\n';
+    os << "  wall       " << r.wall_s << " s (" << r.fps() << " fps)\n";
+    os << "  cpu        " << r.cpu_s << " s (" << (r.wall_s > 0.0 ? r.cpu_s / r.wall_s : 0.0)
+       << " cores)\n";
+    os << "  peak rss   " << static_cast<double>(r.peak_rss_bytes) / (1024.0 * 1024.0) << " MiB\n";
+    os << "  open       " << r.open_ms << " ms\n";
+    os << "  1st frame  " << r.first_frame_ms << " ms\n";
+
+    if (!r.stages.empty()) {
+        os << "  " << std::left << std::setw(26) << "stage" << std::right << std::setw(10)
+           << "count" << std::setw(12) << "mean us" << std::setw(12) << "p50 us" << std::setw(12)
+           << "p99 us" << std::setw(12) << "max us" << '\n';
+
+        for (const auto &[name, s] : r.stages) {
+            os << "  " << std::left << std::setw(26) << name << std::right << std::setw(10)
+               << s.count << std::setw(12) << s.mean_us << std::setw(12) << s.p50_us
+               << std::setw(12) << s.p99_us << std::setw(12) << s.max_us << '\n';
+        }
+    }
+
+    for (const auto &[name, v] : r.metrics) {
+        os << "  " << std::left << std::setw(32) << name << std::right << v << '\n';
+    }
+
+    os.flags(flags);
+}
+
+bool write_report_json(const BenchReport &r, const std::string &path) {
+    std::ofstream os(path);
+    if (!os) {
+        return false;
+    }
+
+    os << std::setprecision(6) << "{\n  \"url\": ";
+    write_json_string(os, r.url);
+    os << ",\n  \"decoder\": ";
+    write_json_string(os, r.decoder);
+    os << ",\n  \"frames\": " << r.frames << ",\n  \"wall_s\": " << r.wall_s
+       << ",\n  \"fps\": " << r.fps() << ",\n  \"cpu_s\": " << r.cpu_s
+       << ",\n  \"peak_rss_bytes\": " << r.peak_rss_bytes << ",\n  \"open_ms\": " << r.open_ms
+       << ",\n  \"first_frame_ms\": " << r.first_frame_ms
+       << ",\n  \"stages\": {";
+
+    for (std::size_t i = 0; i < r.stages.size(); ++i) {
+        os << (i ? ",\n    " : "\n    ");
+        write_json_string(os, r.stages[i].first);
+        os << ": ";
+        write_json_summary(os, r.stages[i].second);
+    }
+
+    os << "\n  },\n  \"metrics\": {";
+
+    for (std::size_t i = 0; i < r.metrics.size(); ++i) {
+        os << (i ? ",\n    " : "\n    ");
+        write_json_string(os, r.metrics[i].first);
+        os << ": " << r.metrics[i].second;
+    }
+
+    os << "\n  }\n}\n";
+    return static_cast<bool>(os);
+}
+}  // namespace splayer
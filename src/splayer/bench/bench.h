@@ -0,0 +1,147 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <splayer/codec/decode/decoder_factory.h>
+#include <splayer/codec/io/input_io.h>
+
+namespace splayer {
+struct BenchOptions {
+    std::string url;
+    // See `open_decoder`
+    DecoderPreference decoder{DecoderPreference::SOFTWARE};
+    // See `Decoder::set_threading`
+    DecodeThreading threading;
+    // Horizontal slices each frame is converted in, see `FrameConverter::set_slices`
+    std::size_t cnvt_slices{1};
+    // See `Decoder::set_probe_cache`
+    bool probe_cache{false};
+    // See `Decoder::set_input_io`
+    InputIoMode input_io{InputIoMode::DEFAULT};
+    InputIoConfig input_io_cfg;
+    // Evict the input from the page cache before each pass of the IO bench
+    bool cold_cache{false};
+    // Times the input is played through by the leak check
+    std::size_t leak_passes{8};
+    // Also write the report as JSON to this path when non-empty.
+    std::string json_path;
+};
+
+class LatencySeries final {
+public:
+    struct Summary {
+        std::size_t count;
+        double mean_us;
+        double p50_us;
+        double p99_us;
+        double max_us;
+    };
+
+    explicit LatencySeries(std::string_view n, std::size_t expected = 0) : series_name(n) {
+        samples.reserve(expected);
+    }
+
+    void add(std::int64_t ns) { samples.push_back(ns); }
+    std::string_view name() const noexcept { return series_name; }
+    Summary summarize() const;
+
+private:
+    std::string series_name;
+    std::vector<std::int64_t> samples;
+};
+
+struct BenchReport {
+    std::string url;
+    std::string decoder;
+    std::size_t frames{};
+    double wall_s{};
+    double cpu_s{};
+    double open_ms{};
+    // From before `open_input` until the first frame is converted
+    double first_frame_ms{};
+    std::int64_t peak_rss_bytes{};
+    std::vector<std::pair<std::string, LatencySeries::Summary>> stages;
+    // Additional scalar results, printed after the stage table.
+    std::vector<std::pair<std::string, double>> metrics;
+
+    double fps() const noexcept { return wall_s > 0.0 ? frames / wall_s : 0.0; }
+};
+
+// Decodes and colour converts `opts.url` as fast as possible without a window or pacing, then
+// times seeks to the target frame with and without the keyframe index. Returns the process exit
+// code.
+int run_bench(const BenchOptions &opts);
+
+// Times every YUV to RGB kernel against swscale on synthetic 4K frames and checks the SIMD kernels
+// are bit exact with the scalar one.
+int run_cnvt_bench(const BenchOptions &opts);
+
+// Demuxes `opts.url` through libavformat's own file protocol, `MmapIo` and `ReadaheadIo`,
+// reporting time, CPU, read syscalls, page faults and the slowest packet of each.
+int run_io_bench(const BenchOptions &opts);
+
+// Converts a synthetic 4K frame to RGB with 1 to N slices, for both the native kernels and
+// swscale.
+int run_slice_bench(const BenchOptions &opts);
+
+// Decodes `opts.url` once per threading configuration: a thread count sweep for every thread type
+// plus low delay variants. Reports throughput, the frames the decoder holds back and the latency
+// of each packet.
+int run_thread_bench(const BenchOptions &opts);
+
+// Uploads a synthetic 4K RGB frame to a texture directly and through rings of two and three pixel
+// buffers, timing the calls on the render thread. Runs in a hidden window, so a headless Mesa
+// (llvmpipe) context works.
+int run_upload_bench(const BenchOptions &opts);
+
+// Plays a synthetic 24 fps stream on a simulated 60 Hz display through a `FrameScheduler`. Fails
+// unless every frame is presented without drops or repeats, and unless a run whose frames
+// periodically arrive late does count repeats.
+int run_sched_bench(const BenchOptions &opts);
+
+// Decodes the first 1000 frames of `opts.url` twice on the calling thread, then once more through
+// a `Pipeline`, and fails if the second run or the pipeline past its first frames allocates.
+// Counts the conversion pool's buffer allocations, and calls to `operator new` from the whole
+// process when built with ENABLE_ALLOC_COUNTER; libav* allocations made through `av_malloc` inside
+// the codec are not visible to it.
+int run_alloc_bench(const BenchOptions &opts);
+
+// Plays `opts.url` through a `Pipeline` `opts.leak_passes` times, seeking back to the start in
+// between, and samples the resident memory after each pass. Fails when it keeps growing after the
+// first pass, i.e. when packets, frames or their buffers leak.
+int run_leak_bench(const BenchOptions &opts);
+
+void print_report(const BenchReport &r, std::ostream &os);
+bool write_report_json(const BenchReport &r, const std::string &path);
+}  // namespace splayer
+
+#endif /* BENCH_H_ */
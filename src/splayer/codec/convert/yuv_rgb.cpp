@@ -0,0 +1,275 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "yuv_rgb.h"
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+}
+
+#include <algorithm>
+#include <cmath>
+
+#include "yuv_rgb_kernels.h"
+
+namespace splayer {
+namespace yuv_kernels {
+namespace {
+constexpr std::int16_t sat16(int v) noexcept {
+    return static_cast<std::int16_t>(std::clamp(v, -32768, 32767));
+}
+
+constexpr std::uint8_t to_u8(std::int16_t v) noexcept {
+    return static_cast<std::uint8_t>(std::clamp((v >> 6), 0, 255));
+}
+
+template <YuvLayout L, RgbLayout O>
+void scalar_row_impl(const YuvCoeffs &c, const std::uint8_t *y, const std::uint8_t *u,
+    const std::uint8_t *v, std::uint8_t *dst, int width) {
+    for (int x = 0; x < width; ++x) {
+        int ys{}, us{}, vs{};
+
+        if constexpr (L == YuvLayout::YUV420P) {
+            ys = y[x];
+            us = u[x / 2];
+            vs = v[x / 2];
+        } else if constexpr (L == YuvLayout::NV12) {
+            ys = y[x];
+            us = u[(x & ~1)];
+            vs = u[(x & ~1) + 1];
+        } else {
+            // High byte of each little endian 16-bit sample
+            ys = y[2 * x + 1];
+            us = u[2 * (x & ~1) + 1];
+            vs = u[2 * (x & ~1) + 3];
+        }
+
+        us -= c.coff;
+        vs -= c.coff;
+
+        const auto yr = sat16((ys - c.yoff) * c.cy + 32);
+        const auto r = to_u8(sat16(yr + vs * c.crv));
+        const auto g = to_u8(sat16(yr + sat16(us * c.cgu + vs * c.cgv)));
+        const auto b = to_u8(sat16(yr + us * c.cbu));
+
+        if constexpr (O == RgbLayout::RGB24) {
+            dst[0] = r;
+            dst[1] = g;
+            dst[2] = b;
+            dst += 3;
+        } else if constexpr (O == RgbLayout::RGBA) {
+            dst[0] = r;
+            dst[1] = g;
+            dst[2] = b;
+            dst[3] = 0xff;
+            dst += 4;
+        } else {
+            dst[0] = b;
+            dst[1] = g;
+            dst[2] = r;
+            dst[3] = 0xff;
+            dst += 4;
+        }
+    }
+}
+
+template <YuvLayout L>
+RowFn scalar_row_for(RgbLayout dst) noexcept {
+    switch (dst) {
+        case RgbLayout::RGB24:
+            return scalar_row_impl<L, RgbLayout::RGB24>;
+        case RgbLayout::RGBA:
+            return scalar_row_impl<L, RgbLayout::RGBA>;
+        case RgbLayout::BGRA:
+            return scalar_row_impl<L, RgbLayout::BGRA>;
+    }
+
+    return nullptr;
+}
+}  // namespace
+
+RowFn scalar_row(YuvLayout src, RgbLayout dst) noexcept {
+    switch (src) {
+        case YuvLayout::YUV420P:
+            return scalar_row_for<YuvLayout::YUV420P>(dst);
+        case YuvLayout::NV12:
+            return scalar_row_for<YuvLayout::NV12>(dst);
+        case YuvLayout::P010:
+            return scalar_row_for<YuvLayout::P010>(dst);
+    }
+
+    return nullptr;
+}
+}  // namespace yuv_kernels
+
+namespace {
+std::int16_t fixed6(float v) noexcept { return static_cast<std::int16_t>(std::lround(v * 64.0F)); }
+
+yuv_kernels::RowFn select_row(SimdLevel level, YuvLayout src, RgbLayout dst) noexcept {
+    yuv_kernels::RowFn fn = nullptr;
+
+    switch (level) {
+        case SimdLevel::AVX512:
+            fn = yuv_kernels::avx512_row(src, dst);
+            break;
+        case SimdLevel::AVX2:
+            fn = yuv_kernels::avx2_row(src, dst);
+            break;
+        case SimdLevel::SSE41:
+            fn = yuv_kernels::sse41_row(src, dst);
+            break;
+        case SimdLevel::SCALAR:
+            break;
+    }
+
+    return (fn ? fn : yuv_kernels::scalar_row(src, dst));
+}
+}  // namespace
+
+YuvToRgb::YuvToRgb(
+    graphics::ColorStandard standard, graphics::ColorRange range, SimdLevel max_level) noexcept
+    : level(std::min(max_level, detect_simd())) {
+    const auto mat = graphics::yuv_to_rgb_matrix(standard, range);
+
+    coeffs.cy = fixed6(mat.m[0]);
+    coeffs.crv = fixed6(mat.m[2]);
+    coeffs.cgu = fixed6(mat.m[4]);
+    coeffs.cgv = fixed6(mat.m[5]);
+    coeffs.cbu = fixed6(mat.m[7]);
+    coeffs.yoff = static_cast<std::int16_t>(std::lround(mat.offset[0] * 255.0F));
+    coeffs.coff = static_cast<std::int16_t>(std::lround(mat.offset[1] * 255.0F));
+}
+
+void YuvToRgb::convert(
+    const YuvImage &src, const RgbImage &dst, int row_beg, int row_end) const noexcept {
+    const auto row = select_row(level, src.layout, dst.layout);
+    const bool planar = (src.layout == YuvLayout::YUV420P);
+
+    for (int r = row_beg; r < row_end; ++r) {
+        const int cr = r / 2;
+
+        row(coeffs, src.data[0] + static_cast<std::ptrdiff_t>(r) * src.linesize[0],
+            src.data[1] + static_cast<std::ptrdiff_t>(cr) * src.linesize[1],
+            planar ? src.data[2] + static_cast<std::ptrdiff_t>(cr) * src.linesize[2] : nullptr,
+            dst.data + static_cast<std::ptrdiff_t>(r) * dst.linesize, src.width);
+    }
+}
+
+SimdLevel YuvToRgb::detect_simd() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return SimdLevel::AVX512;
+    } else if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    } else if (__builtin_cpu_supports("sse4.1")) {
+        return SimdLevel::SSE41;
+    }
+#endif
+
+    return SimdLevel::SCALAR;
+}
+
+std::string_view YuvToRgb::simd_name(SimdLevel l) noexcept {
+    switch (l) {
+        case SimdLevel::SCALAR:
+            return "scalar";
+        case SimdLevel::SSE41:
+            return "sse4.1";
+        case SimdLevel::AVX2:
+            return "avx2";
+        case SimdLevel::AVX512:
+            return "avx512";
+    }
+
+    return "scalar";
+}
+
+std::string_view YuvToRgb::layout_name(YuvLayout l) noexcept {
+    switch (l) {
+        case YuvLayout::YUV420P:
+            return "yuv420p";
+        case YuvLayout::NV12:
+            return "nv12";
+        case YuvLayout::P010:
+            return "p010";
+    }
+
+    return "yuv420p";
+}
+
+std::string_view YuvToRgb::layout_name(RgbLayout l) noexcept {
+    switch (l) {
+        case RgbLayout::RGB24:
+            return "rgb24";
+        case RgbLayout::RGBA:
+            return "rgba";
+        case RgbLayout::BGRA:
+            return "bgra";
+    }
+
+    return "rgb24";
+}
+
+std::optional<YuvLayout> yuv_layout_of(int av_pix_fmt) noexcept {
+    switch (av_pix_fmt) {
+        case AV_PIX_FMT_YUV420P:
+        case AV_PIX_FMT_YUVJ420P:
+            return YuvLayout::YUV420P;
+        case AV_PIX_FMT_NV12:
+            return YuvLayout::NV12;
+        case AV_PIX_FMT_P010LE:
+            return YuvLayout::P010;
+        default:
+            return std::nullopt;
+    }
+}
+
+YuvImage yuv_image_of(const AVFrame *f, YuvLayout layout) noexcept {
+    return {{f->data[0], f->data[1], f->data[2]}, {f->linesize[0], f->linesize[1], f->linesize[2]},
+        f->width, f->height, layout};
+}
+
+graphics::ColorStandard color_standard_of(const AVFrame *f) noexcept {
+    switch (f->colorspace) {
+        case AVCOL_SPC_BT709:
+            return graphics::ColorStandard::BT709;
+        case AVCOL_SPC_BT470BG:
+        case AVCOL_SPC_SMPTE170M:
+            return graphics::ColorStandard::BT601;
+        case AVCOL_SPC_BT2020_NCL:
+            return graphics::ColorStandard::BT2020;
+        default:
+            // Untagged streams: SD content is conventionally 601, HD and up 709.
+            return (f->height >= 720 ? graphics::ColorStandard::BT709
+                                     : graphics::ColorStandard::BT601);
+    }
+}
+
+graphics::ColorRange color_range_of(const AVFrame *f) noexcept {
+    const bool full_range =
+        (f->color_range == AVCOL_RANGE_JPEG || f->format == AV_PIX_FMT_YUVJ420P);
+    return (full_range ? graphics::ColorRange::FULL : graphics::ColorRange::LIMITED);
+}
+}  // namespace splayer
@@ -0,0 +1,106 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef YUV_RGB_H_
+#define YUV_RGB_H_
+
+#include <splayer/display/color_space.h>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+struct AVFrame;
+
+namespace splayer {
+enum class YuvLayout {
+    // 8-bit planar 4:2:0
+    YUV420P,
+    // 8-bit luma plane followed by an interleaved UV plane
+    NV12,
+    // NV12 layout with 10-bit little endian samples in the high bits of 16-bit words
+    P010
+};
+
+enum class RgbLayout { RGB24, RGBA, BGRA };
+
+enum class SimdLevel { SCALAR = 0, SSE41, AVX2, AVX512 };
+
+struct YuvImage {
+    std::array<const std::uint8_t *, 3> data;
+    std::array<int, 3> linesize;
+    int width;
+    int height;
+    YuvLayout layout;
+};
+
+struct RgbImage {
+    std::uint8_t *data;
+    int linesize;
+    RgbLayout layout;
+};
+
+// Coefficients of the 16-bit fixed point conversion, scaled by 64.
+struct YuvCoeffs {
+    std::int16_t cy, crv, cgu, cgv, cbu;
+    std::int16_t yoff, coff;
+};
+
+// YUV to RGB conversion without scaling. Every SIMD kernel is bit exact with the scalar one, which
+// defines the arithmetic: 16-bit products with 6 fractional bits and saturating sums, the same
+// precision swscale and libyuv use on their fast paths. P010 samples are reduced to their top 8
+// bits before conversion as the output only has 8.
+class YuvToRgb final {
+public:
+    explicit YuvToRgb(graphics::ColorStandard standard, graphics::ColorRange range,
+        SimdLevel max_level = SimdLevel::AVX512) noexcept;
+
+    // Converts rows [row_beg, row_end) of `src` into the same rows of `dst`. `row_beg` must be
+    // even for 4:2:0 layouts unless it is the first row.
+    void convert(const YuvImage &src, const RgbImage &dst, int row_beg, int row_end) const noexcept;
+    void convert(const YuvImage &src, const RgbImage &dst) const noexcept {
+        convert(src, dst, 0, src.height);
+    }
+
+    SimdLevel simd_level() const noexcept { return level; }
+
+    static SimdLevel detect_simd() noexcept;
+    static std::string_view simd_name(SimdLevel l) noexcept;
+    static std::string_view layout_name(YuvLayout l) noexcept;
+    static std::string_view layout_name(RgbLayout l) noexcept;
+
+private:
+    YuvCoeffs coeffs;
+    SimdLevel level;
+};
+
+std::optional<YuvLayout> yuv_layout_of(int av_pix_fmt) noexcept;
+YuvImage yuv_image_of(const AVFrame *f, YuvLayout layout) noexcept;
+
+// Colour description of a decoded frame, falling back to the usual conventions for untagged
+// streams.
+graphics::ColorStandard color_standard_of(const AVFrame *f) noexcept;
+graphics::ColorRange color_range_of(const AVFrame *f) noexcept;
+}  // namespace splayer
+
+#endif /* YUV_RGB_H_ */
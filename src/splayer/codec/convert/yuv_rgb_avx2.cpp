@@ -0,0 +1,113 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "yuv_rgb_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+#include <utility>
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+#include "yuv_rgb_simd.h"
+
+namespace splayer::yuv_kernels {
+namespace {
+struct Avx2 {
+    using V = __m256i;
+    static constexpr int PX = 32;
+
+    static V load(const std::uint8_t *p) {
+        return _mm256_loadu_si256(reinterpret_cast<const V *>(p));
+    }
+    // PX / 2 bytes zero extended to 16 bits
+    static V load_widen(const std::uint8_t *p) {
+        return _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+    }
+
+    static V set1_16(std::int16_t v) { return _mm256_set1_epi16(v); }
+    static V set1_32(std::int32_t v) { return _mm256_set1_epi32(v); }
+    static V and_(V a, V b) { return _mm256_and_si256(a, b); }
+    static V sub_16(V a, V b) { return _mm256_sub_epi16(a, b); }
+    static V mullo_16(V a, V b) { return _mm256_mullo_epi16(a, b); }
+    static V adds_16(V a, V b) { return _mm256_adds_epi16(a, b); }
+
+    template <int S>
+    static V srli_16(V a) {
+        return _mm256_srli_epi16(a, S);
+    }
+    template <int S>
+    static V srli_32(V a) {
+        return _mm256_srli_epi32(a, S);
+    }
+    template <int S>
+    static V srai_16(V a) {
+        return _mm256_srai_epi16(a, S);
+    }
+
+    // Packs work within 128-bit lanes, the permute restores element order across them
+    static V pack_32(V lo, V hi) {
+        return _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), 0xd8);
+    }
+    static V pack_u8(V lo, V hi) {
+        return _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xd8);
+    }
+
+    // Each chroma sample covers two horizontally adjacent pixels. Unpacks are also per lane, so
+    // the quarters are first reordered to put chroma 0-3 and 4-7 at the bottom of each lane.
+    static V dup_lo(V c) {
+        const V t = _mm256_permute4x64_epi64(c, 0xd8);
+        return _mm256_unpacklo_epi16(t, t);
+    }
+    static V dup_hi(V c) {
+        const V t = _mm256_permute4x64_epi64(c, 0xd8);
+        return _mm256_unpackhi_epi16(t, t);
+    }
+
+    template <int K>
+    static __m128i chunk(V v) {
+        return _mm256_extracti128_si256(v, K);
+    }
+};
+}  // namespace
+}  // namespace splayer::yuv_kernels
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+namespace splayer::yuv_kernels {
+RowFn avx2_row(YuvLayout src, RgbLayout dst) noexcept { return simd_row_for<Avx2>(src, dst); }
+}  // namespace splayer::yuv_kernels
+#else
+namespace splayer::yuv_kernels {
+RowFn avx2_row(YuvLayout, RgbLayout) noexcept { return nullptr; }
+}  // namespace splayer::yuv_kernels
+#endif
@@ -0,0 +1,122 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "yuv_rgb_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+#include <utility>
+
+#if defined(__GNUC__) && !defined(__clang__)
+// GCC 12's AVX-512 headers trip this through their _mm512_undefined_* placeholders
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f,avx512bw"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512bw")
+#endif
+
+#include "yuv_rgb_simd.h"
+
+namespace splayer::yuv_kernels {
+namespace {
+struct Avx512 {
+    using V = __m512i;
+    static constexpr int PX = 64;
+
+    static V load(const std::uint8_t *p) { return _mm512_loadu_si512(p); }
+    // PX / 2 bytes zero extended to 16 bits
+    static V load_widen(const std::uint8_t *p) {
+        return _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)));
+    }
+
+    static V set1_16(std::int16_t v) { return _mm512_set1_epi16(v); }
+    static V set1_32(std::int32_t v) { return _mm512_set1_epi32(v); }
+    static V and_(V a, V b) { return _mm512_and_si512(a, b); }
+    static V sub_16(V a, V b) { return _mm512_sub_epi16(a, b); }
+    static V mullo_16(V a, V b) { return _mm512_mullo_epi16(a, b); }
+    static V adds_16(V a, V b) { return _mm512_adds_epi16(a, b); }
+
+    template <int S>
+    static V srli_16(V a) {
+        return _mm512_srli_epi16(a, S);
+    }
+    template <int S>
+    static V srli_32(V a) {
+        return _mm512_srli_epi32(a, S);
+    }
+    template <int S>
+    static V srai_16(V a) {
+        return _mm512_srai_epi16(a, S);
+    }
+
+    // Packs work within 128-bit lanes, the permute restores element order across them
+    static V unpack_lanes(V v) {
+        return _mm512_permutexvar_epi64(_mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7), v);
+    }
+    static V pack_32(V lo, V hi) { return unpack_lanes(_mm512_packus_epi32(lo, hi)); }
+    static V pack_u8(V lo, V hi) { return unpack_lanes(_mm512_packus_epi16(lo, hi)); }
+
+    // Each chroma sample covers two horizontally adjacent pixels
+    static V dup_lo(V c) {
+        return _mm512_permutexvar_epi16(_mm512_setr_epi32(0x00000000, 0x00010001, 0x00020002,
+                                            0x00030003, 0x00040004, 0x00050005, 0x00060006,
+                                            0x00070007, 0x00080008, 0x00090009, 0x000a000a,
+                                            0x000b000b, 0x000c000c, 0x000d000d, 0x000e000e,
+                                            0x000f000f),
+            c);
+    }
+    static V dup_hi(V c) {
+        return _mm512_permutexvar_epi16(_mm512_setr_epi32(0x00100010, 0x00110011, 0x00120012,
+                                            0x00130013, 0x00140014, 0x00150015, 0x00160016,
+                                            0x00170017, 0x00180018, 0x00190019, 0x001a001a,
+                                            0x001b001b, 0x001c001c, 0x001d001d, 0x001e001e,
+                                            0x001f001f),
+            c);
+    }
+
+    template <int K>
+    static __m128i chunk(V v) {
+        return _mm512_extracti32x4_epi32(v, K);
+    }
+};
+}  // namespace
+}  // namespace splayer::yuv_kernels
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+namespace splayer::yuv_kernels {
+RowFn avx512_row(YuvLayout src, RgbLayout dst) noexcept { return simd_row_for<Avx512>(src, dst); }
+}  // namespace splayer::yuv_kernels
+#else
+namespace splayer::yuv_kernels {
+RowFn avx512_row(YuvLayout, RgbLayout) noexcept { return nullptr; }
+}  // namespace splayer::yuv_kernels
+#endif
@@ -0,0 +1,63 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef YUV_RGB_KERNELS_H_
+#define YUV_RGB_KERNELS_H_
+
+#include <cstdint>
+
+#include "yuv_rgb.h"
+
+// Row kernels behind `YuvToRgb`, one set per instruction set.
+namespace splayer::yuv_kernels {
+// For NV12 and P010 `u` points at the interleaved UV row and `v` is unused.
+using RowFn = void (*)(const YuvCoeffs &c, const std::uint8_t *y, const std::uint8_t *u,
+    const std::uint8_t *v, std::uint8_t *dst, int width);
+
+RowFn scalar_row(YuvLayout src, RgbLayout dst) noexcept;
+// These return nullptr when the kernels were not built for the target architecture.
+RowFn sse41_row(YuvLayout src, RgbLayout dst) noexcept;
+RowFn avx2_row(YuvLayout src, RgbLayout dst) noexcept;
+RowFn avx512_row(YuvLayout src, RgbLayout dst) noexcept;
+
+constexpr int bytes_per_pixel(RgbLayout l) noexcept { return (l == RgbLayout::RGB24 ? 3 : 4); }
+
+constexpr int luma_offset(YuvLayout l, int x) noexcept {
+    return (l == YuvLayout::P010 ? 2 * x : x);
+}
+
+// Offset of the chroma sample pair for (even) pixel `x` within the `u` row.
+constexpr int chroma_offset(YuvLayout l, int x) noexcept {
+    switch (l) {
+        case YuvLayout::YUV420P:
+            return x / 2;
+        case YuvLayout::NV12:
+            return x;
+        case YuvLayout::P010:
+            return 2 * x;
+    }
+
+    return x;
+}
+}  // namespace splayer::yuv_kernels
+
+#endif /* YUV_RGB_KERNELS_H_ */
@@ -0,0 +1,182 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef YUV_RGB_SIMD_H_
+#define YUV_RGB_SIMD_H_
+
+// Kernel template shared by the SSE4.1, AVX2 and AVX-512 translation units. It is included after
+// each unit switches its target ISA, so everything defined here is compiled for that ISA; it must
+// therefore not pull in other headers itself, which would leak ISA specific copies of their
+// inline functions into the rest of the program.
+
+namespace splayer::yuv_kernels {
+namespace {
+// Interleaves 16 pixels of R, G and B into `dst`, using SSE only so every ISA can share it.
+template <RgbLayout O>
+inline void store16(__m128i r, __m128i g, __m128i b, std::uint8_t *dst) {
+    const __m128i a = _mm_set1_epi8(-1);
+    if constexpr (O == RgbLayout::BGRA) {
+        const __m128i t = r;
+        r = b;
+        b = t;
+    }
+
+    const __m128i rg_lo = _mm_unpacklo_epi8(r, g);
+    const __m128i rg_hi = _mm_unpackhi_epi8(r, g);
+    const __m128i ba_lo = _mm_unpacklo_epi8(b, a);
+    const __m128i ba_hi = _mm_unpackhi_epi8(b, a);
+
+    __m128i p0 = _mm_unpacklo_epi16(rg_lo, ba_lo);
+    __m128i p1 = _mm_unpackhi_epi16(rg_lo, ba_lo);
+    __m128i p2 = _mm_unpacklo_epi16(rg_hi, ba_hi);
+    __m128i p3 = _mm_unpackhi_epi16(rg_hi, ba_hi);
+
+    auto *out = reinterpret_cast<__m128i *>(dst);
+
+    if constexpr (O == RgbLayout::RGB24) {
+        // Drop alpha (12 useful bytes per register) and stitch the four registers into three
+        const __m128i drop_a =
+            _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+        p0 = _mm_shuffle_epi8(p0, drop_a);
+        p1 = _mm_shuffle_epi8(p1, drop_a);
+        p2 = _mm_shuffle_epi8(p2, drop_a);
+        p3 = _mm_shuffle_epi8(p3, drop_a);
+
+        _mm_storeu_si128(out + 0, _mm_or_si128(p0, _mm_slli_si128(p1, 12)));
+        _mm_storeu_si128(out + 1, _mm_or_si128(_mm_srli_si128(p1, 4), _mm_slli_si128(p2, 8)));
+        _mm_storeu_si128(out + 2, _mm_or_si128(_mm_srli_si128(p2, 8), _mm_slli_si128(p3, 4)));
+    } else {
+        _mm_storeu_si128(out + 0, p0);
+        _mm_storeu_si128(out + 1, p1);
+        _mm_storeu_si128(out + 2, p2);
+        _mm_storeu_si128(out + 3, p3);
+    }
+}
+
+// `Isa` provides the vector type `V` holding `PX / 2` 16-bit lanes, so one iteration converts
+// `PX` pixels as two halves sharing one vector of chroma.
+template <typename Isa, YuvLayout L, RgbLayout O>
+void simd_row(const YuvCoeffs &c, const std::uint8_t *y, const std::uint8_t *u,
+    const std::uint8_t *v, std::uint8_t *dst, int width) {
+    using V = typename Isa::V;
+    constexpr int PX = Isa::PX;
+    constexpr int BPP = bytes_per_pixel(O);
+
+    const V cy = Isa::set1_16(c.cy);
+    const V crv = Isa::set1_16(c.crv);
+    const V cgu = Isa::set1_16(c.cgu);
+    const V cgv = Isa::set1_16(c.cgv);
+    const V cbu = Isa::set1_16(c.cbu);
+    const V yoff = Isa::set1_16(c.yoff);
+    const V coff = Isa::set1_16(c.coff);
+    const V round = Isa::set1_16(32);
+    const V lo8 = Isa::set1_16(0x00ff);
+    const V lo16 = Isa::set1_32(0xffff);
+
+    int x = 0;
+    for (; x + PX <= width; x += PX) {
+        V y0, y1, cu, cv;
+
+        if constexpr (L == YuvLayout::YUV420P) {
+            y0 = Isa::load_widen(y + x);
+            y1 = Isa::load_widen(y + x + PX / 2);
+            cu = Isa::load_widen(u + x / 2);
+            cv = Isa::load_widen(v + x / 2);
+        } else if constexpr (L == YuvLayout::NV12) {
+            y0 = Isa::load_widen(y + x);
+            y1 = Isa::load_widen(y + x + PX / 2);
+            const V uv = Isa::load(u + x);
+            cu = Isa::and_(uv, lo8);
+            cv = Isa::template srli_16<8>(uv);
+        } else {
+            y0 = Isa::template srli_16<8>(Isa::load(y + 2 * x));
+            y1 = Isa::template srli_16<8>(Isa::load(y + 2 * x + PX));
+            const V uv0 = Isa::template srli_16<8>(Isa::load(u + 2 * x));
+            const V uv1 = Isa::template srli_16<8>(Isa::load(u + 2 * x + PX));
+            cu = Isa::pack_32(Isa::and_(uv0, lo16), Isa::and_(uv1, lo16));
+            cv = Isa::pack_32(Isa::template srli_32<16>(uv0), Isa::template srli_32<16>(uv1));
+        }
+
+        cu = Isa::sub_16(cu, coff);
+        cv = Isa::sub_16(cv, coff);
+
+        const V rv = Isa::mullo_16(cv, crv);
+        const V gc = Isa::adds_16(Isa::mullo_16(cu, cgu), Isa::mullo_16(cv, cgv));
+        const V bu = Isa::mullo_16(cu, cbu);
+
+        y0 = Isa::adds_16(Isa::mullo_16(Isa::sub_16(y0, yoff), cy), round);
+        y1 = Isa::adds_16(Isa::mullo_16(Isa::sub_16(y1, yoff), cy), round);
+
+        const auto channel = [&](V chroma) {
+            const V lo = Isa::template srai_16<6>(Isa::adds_16(y0, Isa::dup_lo(chroma)));
+            const V hi = Isa::template srai_16<6>(Isa::adds_16(y1, Isa::dup_hi(chroma)));
+            return Isa::pack_u8(lo, hi);
+        };
+
+        const V r = channel(rv);
+        const V g = channel(gc);
+        const V b = channel(bu);
+
+        [&]<int... K>(std::integer_sequence<int, K...>) {
+            (store16<O>(Isa::template chunk<K>(r), Isa::template chunk<K>(g),
+                 Isa::template chunk<K>(b), dst + (x + 16 * K) * BPP),
+                ...);
+        }(std::make_integer_sequence<int, PX / 16>{});
+    }
+
+    if (x < width) {
+        scalar_row(L, O)(c, y + luma_offset(L, x), u + chroma_offset(L, x),
+            (L == YuvLayout::YUV420P ? v + x / 2 : v), dst + x * BPP, width - x);
+    }
+}
+
+template <typename Isa, YuvLayout L>
+RowFn simd_row_for(RgbLayout dst) noexcept {
+    switch (dst) {
+        case RgbLayout::RGB24:
+            return simd_row<Isa, L, RgbLayout::RGB24>;
+        case RgbLayout::RGBA:
+            return simd_row<Isa, L, RgbLayout::RGBA>;
+        case RgbLayout::BGRA:
+            return simd_row<Isa, L, RgbLayout::BGRA>;
+    }
+
+    return nullptr;
+}
+
+template <typename Isa>
+RowFn simd_row_for(YuvLayout src, RgbLayout dst) noexcept {
+    switch (src) {
+        case YuvLayout::YUV420P:
+            return simd_row_for<Isa, YuvLayout::YUV420P>(dst);
+        case YuvLayout::NV12:
+            return simd_row_for<Isa, YuvLayout::NV12>(dst);
+        case YuvLayout::P010:
+            return simd_row_for<Isa, YuvLayout::P010>(dst);
+    }
+
+    return nullptr;
+}
+}  // namespace
+}  // namespace splayer::yuv_kernels
+
+#endif /* YUV_RGB_SIMD_H_ */
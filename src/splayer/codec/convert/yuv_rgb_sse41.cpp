@@ -0,0 +1,99 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "yuv_rgb_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+#include <utility>
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse4.1"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#endif
+
+#include "yuv_rgb_simd.h"
+
+namespace splayer::yuv_kernels {
+namespace {
+struct Sse41 {
+    using V = __m128i;
+    static constexpr int PX = 16;
+
+    static V load(const std::uint8_t *p) { return _mm_loadu_si128(reinterpret_cast<const V *>(p)); }
+    // PX / 2 bytes zero extended to 16 bits
+    static V load_widen(const std::uint8_t *p) {
+        return _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const V *>(p)));
+    }
+
+    static V set1_16(std::int16_t v) { return _mm_set1_epi16(v); }
+    static V set1_32(std::int32_t v) { return _mm_set1_epi32(v); }
+    static V and_(V a, V b) { return _mm_and_si128(a, b); }
+    static V sub_16(V a, V b) { return _mm_sub_epi16(a, b); }
+    static V mullo_16(V a, V b) { return _mm_mullo_epi16(a, b); }
+    static V adds_16(V a, V b) { return _mm_adds_epi16(a, b); }
+
+    template <int S>
+    static V srli_16(V a) {
+        return _mm_srli_epi16(a, S);
+    }
+    template <int S>
+    static V srli_32(V a) {
+        return _mm_srli_epi32(a, S);
+    }
+    template <int S>
+    static V srai_16(V a) {
+        return _mm_srai_epi16(a, S);
+    }
+
+    static V pack_32(V lo, V hi) { return _mm_packus_epi32(lo, hi); }
+    static V pack_u8(V lo, V hi) { return _mm_packus_epi16(lo, hi); }
+
+    // Each chroma sample covers two horizontally adjacent pixels
+    static V dup_lo(V c) { return _mm_unpacklo_epi16(c, c); }
+    static V dup_hi(V c) { return _mm_unpackhi_epi16(c, c); }
+
+    template <int K>
+    static __m128i chunk(V v) {
+        return v;
+    }
+};
+}  // namespace
+}  // namespace splayer::yuv_kernels
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+namespace splayer::yuv_kernels {
+RowFn sse41_row(YuvLayout src, RgbLayout dst) noexcept { return simd_row_for<Sse41>(src, dst); }
+}  // namespace splayer::yuv_kernels
+#else
+namespace splayer::yuv_kernels {
+RowFn sse41_row(YuvLayout, RgbLayout) noexcept { return nullptr; }
+}  // namespace splayer::yuv_kernels
+#endif
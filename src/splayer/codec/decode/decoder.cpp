@@ -22,4 +22,438 @@
 
 #include "decoder.h"
 
-namespace splayer {}  // namespace splayer
\ No newline at end of file
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+#include <splayer/util/profiler.h>
+#include <splayer/util/utils.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <string_view>
+#include <utility>
+
+using namespace utils;
+
+namespace splayer {
+namespace {
+// Validates the cached stream against what the demuxer found in the header before touching
+// anything, then fills in what `avformat_find_stream_info` would have.
+bool apply_probe_info(AVFormatContext *fmt, const ProbeInfo &info) {
+    if (info.stream_index >= static_cast<int>(fmt->nb_streams)) {
+        return false;
+    }
+
+    auto *st = fmt->streams[info.stream_index];
+    const auto cached_id = info.codecpar->codec_id;
+    if (st->codecpar->codec_type != AVMEDIA_TYPE_VIDEO ||
+        (st->codecpar->codec_id != AV_CODEC_ID_NONE && st->codecpar->codec_id != cached_id) ||
+        av_cmp_q(st->time_base, info.time_base) != 0) {
+        return false;
+    }
+
+    if (avcodec_parameters_copy(st->codecpar, info.codecpar.get()) < 0) {
+        return false;
+    }
+
+    st->r_frame_rate = info.r_frame_rate;
+    st->avg_frame_rate = info.avg_frame_rate;
+    if (st->start_time == AV_NOPTS_VALUE) {
+        st->start_time = info.start_time;
+    }
+
+    if (st->duration == AV_NOPTS_VALUE) {
+        st->duration = info.duration;
+    }
+
+    if (fmt->duration == AV_NOPTS_VALUE && info.duration != AV_NOPTS_VALUE) {
+        fmt->duration = av_rescale_q(info.duration, info.time_base, AVRational{1, AV_TIME_BASE});
+    }
+
+    return true;
+}
+
+// Formats that resynchronise on whatever byte they are handed. The container demuxers (mov,
+// matroska, ...) read from their own sample index, a byte seek moves the file position under
+// them without updating it.
+bool seeks_by_position(const AVInputFormat *ifmt) noexcept {
+    constexpr std::array<std::string_view, 8> names{
+        "mpegts", "mpeg", "mpegvideo", "h264", "hevc", "m4v", "vc1", "cavsvideo"};
+
+    if (ifmt->flags & AVFMT_NO_BYTE_SEEK) {
+        return false;
+    }
+
+    return std::find(names.begin(), names.end(), std::string_view(ifmt->name)) != names.end();
+}
+}  // namespace
+
+const char *thread_type_name(ThreadType t) noexcept {
+    switch (t) {
+        case ThreadType::FRAME:
+            return "frame";
+        case ThreadType::SLICE:
+            return "slice";
+        case ThreadType::BOTH:
+            return "frame/slice";
+    }
+
+    return "unknown";
+}
+
+const char *decode_quality_name(DecodeQuality q) noexcept {
+    switch (q) {
+        case DecodeQuality::FULL:
+            return "full";
+        case DecodeQuality::SKIP_LOOP_FILTER:
+            return "skip loop filter";
+        case DecodeQuality::SKIP_NONREF:
+            return "skip non-reference frames";
+        case DecodeQuality::KEYFRAMES_ONLY:
+            return "keyframes only";
+    }
+
+    return "unknown";
+}
+
+Decoder::~Decoder() {
+    // Keep whatever part of the keyframe index this run added for the next one
+    keyframes_.break_span();
+    if (probe_ && probe_->codecpar && keyframes_.size() != probe_keyframes_) {
+        try {
+            probe_->keyframes = keyframes_.entries();
+            probe_->spans = keyframes_.closed_spans();
+            store_probe_info(*probe_);
+        } catch (const std::exception &e) {
+            Log(Log::ERROR) << "Failed to update probe cache: " << e.what();
+        }
+    }
+
+    // Custom IO, if any, goes after this
+    avformat_close_input(&format_ctx_);
+}
+
+void Decoder::open_input(const std::string &url) {
+    open_demuxer(url);
+    setup_codec();
+}
+
+void Decoder::open_demuxer(const std::string &url) {
+    int ret{};
+    auto **fmt = &format_ctx_;
+
+    input_io_.reset();
+    if (input_io_mode_ != InputIoMode::DEFAULT) {
+        if (const auto path = local_path_of(url)) {
+            try {
+                input_io_ = make_input_io(input_io_mode_, *path, input_io_cfg_);
+            } catch (const std::exception &e) {
+                Log(Log::ERROR) << e.what() << " Falling back to the default protocol.";
+            }
+        }
+    }
+
+    if (input_io_) {
+        *fmt = avformat_alloc_context();
+        if (!*fmt) {
+            Log(Log::ERROR) << "Failed to allocate format context.";
+            throw DecoderError(DecoderErrorDesc::FAILURE);
+        }
+
+        (*fmt)->pb = input_io_->avio();
+    }
+
+    // Note: avformat_open_input will allocate our context for us, unless custom IO needed it
+    // allocated up front.
+    ret = avformat_open_input(fmt, url.c_str(), nullptr, nullptr);
+    if (ret < 0) {
+        Log(Log::ERROR) << "Failed to open input stream and/or read the header of: " << url;
+        throw DecoderError(DecoderErrorDesc::FAILURE, ret);
+    }
+
+    probe_.reset();
+    probe_cache_hit_ = false;
+
+    auto key = (probe_cache_enabled_ ? probe_key_of(url) : std::nullopt);
+    if (key) {
+        if (auto info = load_probe_info(*key)) {
+            // Formats without a header only create their streams while demuxing. A short probe
+            // finds them, the cached parameters fill in what it didn't get to. The full probe
+            // below takes over if it fails.
+            bool probed = true;
+            if (static_cast<int>((*fmt)->nb_streams) <= info->stream_index) {
+                const auto max_analyze = std::exchange((*fmt)->max_analyze_duration,
+                                                       std::int64_t{AV_TIME_BASE / 10});
+                const auto fps_probe = std::exchange((*fmt)->fps_probe_size, 0);
+                probed = (avformat_find_stream_info(*fmt, nullptr) >= 0);
+                (*fmt)->max_analyze_duration = max_analyze;
+                (*fmt)->fps_probe_size = fps_probe;
+            }
+
+            if (!probed) {
+                SPLAYER_LOG(INFO) << "Short probe of " << url << " failed, probing it in full.";
+            } else if (apply_probe_info(*fmt, *info)) {
+                keyframes_.assign(info->keyframes, info->spans);
+                probe_keyframes_ = keyframes_.size();
+                probe_ = std::move(info);
+                probe_cache_hit_ = true;
+
+                SPLAYER_LOG(INFO) << "Configured " << url << " from its probe cache.";
+            } else {
+                SPLAYER_LOG(INFO) << "Ignoring stale probe cache of " << url;
+            }
+        }
+
+        if (!probe_cache_hit_) {
+            probe_ = ProbeInfo{};
+            probe_->key = std::move(*key);
+        }
+    }
+
+    if (!probe_cache_hit_) {
+        ret = avformat_find_stream_info(*fmt, nullptr);
+        if (ret < 0) {
+            Log(Log::ERROR) << "Failed to read stream information.";
+            throw DecoderError(DecoderErrorDesc::FAILURE, ret);
+        }
+    }
+
+    const int wanted_stream = (probe_cache_hit_ ? probe_->stream_index : -1);
+    ret = av_find_best_stream(*fmt, AVMEDIA_TYPE_VIDEO, wanted_stream, -1, nullptr, 0);
+    if (ret < 0) {
+        Log(Log::ERROR) << "Failed to find valid stream/decoder.";
+        throw DecoderError(DecoderErrorDesc::FAILURE, ret);
+    }
+
+    best_vid_stream_id_ = ret;
+
+    // Lets the demuxer skip the payload of every other stream instead of reading it into packets
+    // only for `read_packet` to drop them.
+    for (unsigned i = 0; i < (*fmt)->nb_streams; ++i) {
+        if (static_cast<int>(i) != best_vid_stream_id_) {
+            (*fmt)->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+
+    cache_probe();
+}
+
+void Decoder::cache_probe() {
+    if (!probe_ || probe_cache_hit_) {
+        return;
+    }
+
+    const int stream_id = best_vid_stream_id_;
+    const auto *st = format_ctx_->streams[stream_id];
+
+    probe_->codecpar.reset(avcodec_parameters_alloc());
+    if (!probe_->codecpar || avcodec_parameters_copy(probe_->codecpar.get(), st->codecpar) < 0) {
+        probe_.reset();
+        return;
+    }
+
+    probe_->stream_index = stream_id;
+    probe_->time_base = st->time_base;
+    probe_->r_frame_rate = st->r_frame_rate;
+    probe_->avg_frame_rate = st->avg_frame_rate;
+    probe_->start_time = st->start_time;
+    probe_->duration = st->duration;
+    probe_keyframes_ = 0;
+
+    if (!store_probe_info(*probe_)) {
+        Log(Log::ERROR) << "Failed to write probe cache " << probe_sidecar_path(probe_->key.path);
+    }
+}
+
+bool Decoder::packet_is_from_video_stream(const AVPacket *p) const noexcept {
+    return (p->stream_index == best_vid_stream_id_);
+}
+
+bool Decoder::read_packet(AVPacket *p) {
+    PROF_ZONE(READ_FRAME);
+
+    if (!replay_.empty()) {
+        av_packet_move_ref(p, replay_.front().get());
+        replay_.pop_front();
+        return true;
+    }
+
+    while (av_read_frame(format_ctx_, p) >= 0) {
+        if (packet_is_from_video_stream(p)) {
+            keyframes_.add_packet(p);
+            return true;
+        }
+
+        // A stream that only appeared while demuxing, skipped from now on like the others
+        if (p->stream_index >= 0 && p->stream_index < static_cast<int>(format_ctx_->nb_streams)) {
+            format_ctx_->streams[p->stream_index]->discard = AVDISCARD_ALL;
+        }
+
+        av_packet_unref(p);
+    }
+
+    return false;
+}
+
+void Decoder::adopt_input(Decoder &from) noexcept {
+    format_ctx_ = std::exchange(from.format_ctx_, nullptr);
+    best_vid_stream_id_ = std::exchange(from.best_vid_stream_id_, -1);
+    input_io_ = std::move(from.input_io_);
+    keyframes_ = std::exchange(from.keyframes_, KeyframeIndex{});
+    seek_target_ = std::exchange(from.seek_target_, AV_NOPTS_VALUE);
+    replay_ = std::move(from.replay_);
+    from.replay_.clear();
+
+    probe_cache_hit_ = from.probe_cache_hit_;
+    probe_ = std::move(from.probe_);
+    from.probe_.reset();
+    probe_keyframes_ = from.probe_keyframes_;
+}
+
+void Decoder::replay_packets(std::vector<AVPacketPtr> pkts) {
+    for (auto &p : pkts) {
+        replay_.push_back(std::move(p));
+    }
+}
+
+void Decoder::seek(double seconds, SeekMode mode) {
+    auto *fmt = format_ctx_;
+    const int stream_id = best_vid_stream_id_;
+    const auto *st = fmt->streams[stream_id];
+    const auto start = (st->start_time != AV_NOPTS_VALUE ? st->start_time : 0);
+    const auto target = start + std::llround(std::max(seconds, 0.0) / av_q2d(st->time_base));
+
+    int ret{-1};
+    if (const auto kf = keyframes_.find(target)) {
+        // Byte offsets skip the demuxer's own search entirely where the format allows them,
+        // otherwise pinning both bounds to the keyframe leaves it nothing to search for.
+        if (kf->pos >= 0 && seeks_by_position(fmt->iformat)) {
+            ret = av_seek_frame(fmt, stream_id, kf->pos, AVSEEK_FLAG_BYTE);
+        }
+
+        if (ret < 0 && kf->dts != AV_NOPTS_VALUE) {
+            ret = avformat_seek_file(fmt, stream_id, kf->dts, kf->dts, kf->dts, 0);
+        }
+    }
+
+    if (ret < 0) {
+        ret = avformat_seek_file(fmt, stream_id, INT64_MIN, target, target, 0);
+    }
+
+    if (ret < 0) {
+        Log(Log::ERROR) << "Failed to seek to " << seconds << "s.";
+        throw DecoderError(DecoderErrorDesc::FAILURE, ret);
+    }
+
+    avcodec_flush_buffers(codec_context());
+    replay_.clear();
+    keyframes_.break_span();
+    seek_target_ = (mode == SeekMode::EXACT ? target : AV_NOPTS_VALUE);
+}
+
+double Decoder::clip_fps() const noexcept {
+    return av_q2d(format_ctx_->streams[best_vid_stream_id_]->r_frame_rate);
+}
+
+AVRational Decoder::clip_time_base() const noexcept {
+    return format_ctx_->streams[best_vid_stream_id_]->time_base;
+}
+
+double Decoder::clip_duration() const noexcept {
+    const auto *st = format_ctx_->streams[best_vid_stream_id_];
+    if (st->duration != AV_NOPTS_VALUE) {
+        return static_cast<double>(st->duration) * av_q2d(st->time_base);
+    }
+
+    return (format_ctx_->duration != AV_NOPTS_VALUE
+                ? static_cast<double>(format_ctx_->duration) / AV_TIME_BASE
+                : 0.0);
+}
+
+std::tuple<int, int> Decoder::clip_dims() const noexcept {
+    const auto *par = format_ctx_->streams[best_vid_stream_id_]->codecpar;
+    return {par->width, par->height};
+}
+
+void Decoder::apply_threading(AVCodecContext *ctx, const AVCodec *codec) const {
+    const bool frame = (threading_.type != ThreadType::SLICE && !threading_.low_delay);
+    const bool slice = (threading_.type != ThreadType::FRAME);
+
+    int type{};
+    if (frame && (codec->capabilities & AV_CODEC_CAP_FRAME_THREADS)) {
+        type |= FF_THREAD_FRAME;
+    }
+
+    if (slice && (codec->capabilities & AV_CODEC_CAP_SLICE_THREADS)) {
+        type |= FF_THREAD_SLICE;
+    }
+
+    if (type) {
+        ctx->thread_type = type;
+        ctx->thread_count = threading_.threads;
+    } else {
+        if (threading_.threads != 1) {
+            SPLAYER_LOG(INFO) << "Codec " << codec->name << " has no "
+                              << thread_type_name(threading_.type)
+                              << " threading, decoding single threaded.";
+        }
+
+        ctx->thread_count = 1;
+    }
+
+    if (threading_.low_delay) {
+        ctx->flags |= AV_CODEC_FLAG_LOW_DELAY;
+    }
+}
+
+DecodeThreading Decoder::active_threading() noexcept {
+    const auto *ctx = codec_context();
+
+    DecodeThreading t;
+    t.threads = ctx->thread_count;
+    t.type = (ctx->active_thread_type & FF_THREAD_FRAME ? ThreadType::FRAME : ThreadType::SLICE);
+    t.low_delay = (ctx->flags & AV_CODEC_FLAG_LOW_DELAY);
+    if (!ctx->active_thread_type) {
+        t.threads = 1;
+    }
+
+    return t;
+}
+
+void Decoder::set_quality(DecodeQuality q) noexcept {
+    auto *ctx = codec_context();
+
+    ctx->skip_loop_filter =
+        (q >= DecodeQuality::SKIP_LOOP_FILTER ? AVDISCARD_ALL : AVDISCARD_DEFAULT);
+
+    switch (q) {
+        case DecodeQuality::FULL:
+        case DecodeQuality::SKIP_LOOP_FILTER:
+            ctx->skip_frame = AVDISCARD_DEFAULT;
+            break;
+        case DecodeQuality::SKIP_NONREF:
+            ctx->skip_frame = AVDISCARD_NONREF;
+            break;
+        case DecodeQuality::KEYFRAMES_ONLY:
+            ctx->skip_frame = AVDISCARD_NONKEY;
+            break;
+    }
+}
+
+bool Decoder::before_seek_target(const AVFrame *f) noexcept {
+    if (seek_target_ == AV_NOPTS_VALUE) {
+        return false;
+    }
+
+    const auto ts =
+        (f->best_effort_timestamp != AV_NOPTS_VALUE ? f->best_effort_timestamp : f->pts);
+    if (ts != AV_NOPTS_VALUE && ts < seek_target_) {
+        return true;
+    }
+
+    seek_target_ = AV_NOPTS_VALUE;
+    return false;
+}
+}  // namespace splayer
\ No newline at end of file
@@ -20,21 +20,29 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#ifndef DECODER_H_
+#define DECODER_H_
+
 #include <array>
+#include <cstdint>
+#include <deque>
 #include <memory>
+#include <optional>
 #include <string>
+#include <tuple>
+#include <vector>
 
-extern "C" {
-#include <libavutil/frame.h>
-}
+#include <splayer/codec/io/input_io.h>
 
-namespace splayer {
-struct AvFramePtrDeleter {
-    void operator()(AVFrame *f) noexcept { av_frame_free(&f); }
-};
+#include "av_ptr.h"
+#include "frame_converter.h"
+#include "frame_pool.h"
+#include "keyframe_index.h"
+#include "probe_cache.h"
 
-using AVFramePtr = std::unique_ptr<AVFrame, AvFramePtrDeleter>;
+struct AVFormatContext;
 
+namespace splayer {
 enum class DecoderErrorDesc { FAILURE = -1, SUCCESS = 0 };
 class DecoderError {
 public:
@@ -56,13 +64,176 @@ private:
     int err_code{};
 };
 
+enum class SeekMode {
+    // Resume from the keyframe at or before the target, the first frame out may be early
+    KEYFRAME,
+    // Decode from that keyframe but drop every frame before the target
+    EXACT
+};
+
+enum class ThreadType {
+    // One thread per frame in flight, adds a frame of delay per thread
+    FRAME,
+    // Threads split each frame, only as good as the number of slices the stream was coded with
+    SLICE,
+    // Frame threads where the codec has them, slice threads otherwise
+    BOTH
+};
+
+struct DecodeThreading {
+    // 0 picks one thread per core, 1 disables threading
+    int threads{0};
+    ThreadType type{ThreadType::BOTH};
+    // Sets AV_CODEC_FLAG_LOW_DELAY and never uses frame threads
+    bool low_delay{false};
+};
+
+const char *thread_type_name(ThreadType t) noexcept;
+
+// Ever cheaper decoding, each level keeps the savings of the ones before it.
+enum class DecodeQuality {
+    FULL,
+    // Deblocking skipped, some blocking artifacts in exchange for a large share of decode time
+    SKIP_LOOP_FILTER,
+    // Frames nothing else references are not decoded at all
+    SKIP_NONREF,
+    // Keyframes only
+    KEYFRAMES_ONLY
+};
+
+const char *decode_quality_name(DecodeQuality q) noexcept;
+
+// Each stage below is only ever driven from a single thread at a time: `read_packet` owns the
+// format context, `send_packet`/`receive_frame` own the codec context and `convert_frame` owns the
+// converter, so the three may run concurrently on different threads.
+//
+// The demuxing side (format context, stream selection, keyframe index, probe cache, custom IO) is
+// shared by every decoder and lives here; the concrete decoders only bring their codec setup. That
+// split lets `open_decoder` hand an already opened input from a failed hardware decoder to a
+// software one.
 class Decoder {
 public:
-    virtual void open_input(const std::string &url) = 0;
-    virtual ~Decoder() = default;
+    void open_input(const std::string &url);
+
+    // Demux stage. Fills `pkt` with the next packet of the selected video stream; returns false at
+    // end of input.
+    bool read_packet(AVPacket *pkt);
+    // Decode stage. A null `pkt` enters draining mode.
+    virtual void send_packet(const AVPacket *pkt) = 0;
+    // Decode stage. Returns false when the decoder needs more input (or is fully drained).
+    virtual bool receive_frame(AVFrame *out) = 0;
+    // Conversion stage. Returns a pooled frame in the display pixel format, or an empty pointer
+    // if every pooled frame is still held by a consumer.
+    PooledFramePtr convert_frame(const AVFrame *src) { return converter_.convert(src); }
+
+    // All three stages in one call, for single threaded use. Frames go back to the conversion pool
+    // once the returned pointer is released; an empty pointer means end of input.
+    virtual PooledFramePtr decode_frame() = 0;
+
+    // Repositions the input to `seconds` from the start of the clip. Must not race any of the
+    // stages above, i.e. a pipeline running them has to be stopped first.
+    virtual void seek(double seconds, SeekMode mode);
+
+    virtual double clip_fps() const noexcept;
+    virtual AVRational clip_time_base() const noexcept;
+    virtual double clip_duration() const noexcept;
+    // Coded dimensions reported by the container, decoded frames may differ after a mid-stream
+    // resolution change.
+    virtual std::tuple<int, int> clip_dims() const noexcept;
+
+    // Short description of the decoding path, e.g. "sw" or "hw (cuda)"
+    virtual std::string name() const = 0;
+
+    // Selects the layout handed out by `convert_frame`, set before decoding starts.
+    void set_cnvt_target(CnvtTarget t) noexcept { converter_.set_target(t); }
+    // See `FrameConverter::set_slices`
+    void set_cnvt_slices(std::size_t n) { converter_.set_slices(n); }
+    // Output buffers the conversion stage allocated so far, see `FramePool::buffer_allocations`
+    std::uint64_t cnvt_buffer_allocations() const noexcept {
+        return converter_.buffer_allocations();
+    }
+    // See `FrameConverter::frames_out`
+    std::size_t cnvt_frames_out() const noexcept { return converter_.frames_out(); }
+    // See `FrameConverter::set_output_size`
+    void set_cnvt_size(int width, int height) noexcept {
+        converter_.set_output_size(width, height);
+    }
+
+    // Threading of the codec, set before `open_input`. Types the codec doesn't support are
+    // dropped, leaving it single threaded if none is left.
+    void set_threading(const DecodeThreading &t) noexcept { threading_ = t; }
+    // What the opened codec actually runs with
+    DecodeThreading active_threading() noexcept;
+
+    // Decode stage. Takes effect from the next packet sent, so it has to be called from the thread
+    // driving `send_packet`/`receive_frame`.
+    void set_quality(DecodeQuality q) noexcept;
+
+    // Keeps what probing a local file found in a sidecar next to it, set before `open_input`.
+    // Reopening an unchanged file then skips `avformat_find_stream_info` and starts out with the
+    // keyframe index of earlier runs.
+    void set_probe_cache(bool on) noexcept { probe_cache_enabled_ = on; }
+    bool probe_cache_hit() const noexcept { return probe_cache_hit_; }
+
+    // How local files are read, set before `open_input`. Other inputs always use the protocol
+    // libavformat picks.
+    void set_input_io(InputIoMode m, const InputIoConfig &cfg = {}) {
+        input_io_mode_ = m;
+        input_io_cfg_ = cfg;
+    }
+    // Counters of the custom IO, if any. Must not race `read_packet`.
+    InputIoStats input_io_stats() const { return input_io_ ? input_io_->stats() : InputIoStats{}; }
+
+    virtual ~Decoder();
 
 protected:
+    explicit Decoder(int sws_flags) : converter_(sws_flags) {}
+
+    // Finds a decoder for `best_vid_stream_id_` and opens it, the input is already open.
+    virtual void setup_codec() = 0;
+    virtual AVCodecContext *codec_context() noexcept = 0;
+
+    // True for frames still ahead of an exact seek target, which are dropped.
+    bool before_seek_target(const AVFrame *f) noexcept;
+    // Applies the threading policy to `ctx` ahead of `avcodec_open2`
+    void apply_threading(AVCodecContext *ctx, const AVCodec *codec) const;
+
+    FrameConverter converter_;
+    DecodeThreading threading_;
+
+    AVFormatContext *format_ctx_{nullptr};
+    int best_vid_stream_id_{-1};
+
 private:
     friend DecoderError;
+    friend struct DecoderFactory;
+
+    // Opens `url` and selects its video stream, its streams configured either from the probe cache
+    // or by probing them.
+    void open_demuxer(const std::string &url);
+    // Records the probe results for the chosen stream when they did not come from the cache.
+    void cache_probe();
+    // Takes over the open input of `from`, which is left without one.
+    void adopt_input(Decoder &from) noexcept;
+    // Hands `pkts` out again from `read_packet` before anything new is demuxed.
+    void replay_packets(std::vector<AVPacketPtr> pkts);
+    bool packet_is_from_video_stream(const AVPacket *p) const noexcept;
+
+    KeyframeIndex keyframes_;
+    std::int64_t seek_target_{AV_NOPTS_VALUE};
+    std::deque<AVPacketPtr> replay_;
+
+    bool probe_cache_enabled_{false};
+    bool probe_cache_hit_{false};
+    std::optional<ProbeInfo> probe_;
+    // Index size the sidecar was last written with
+    std::size_t probe_keyframes_{};
+
+    InputIoMode input_io_mode_{InputIoMode::DEFAULT};
+    InputIoConfig input_io_cfg_;
+    // Must outlive the format context, which the destructor closes first
+    std::unique_ptr<InputIo> input_io_;
 };
-}  // namespace splayer
\ No newline at end of file
+}  // namespace splayer
+
+#endif /* DECODER_H_ */
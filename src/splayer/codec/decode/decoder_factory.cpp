@@ -0,0 +1,176 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "decoder_factory.h"
+
+#include <exception>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <splayer/util/utils.h>
+
+#include "hw_decode.h"
+#include "sw_fallback.h"
+
+using namespace utils;
+
+namespace splayer {
+namespace {
+// Packets the hardware decoder may take to produce its first frame, which covers the decoder delay
+// of any sane stream
+constexpr int TRIAL_PACKETS = 256;
+
+std::string describe(const DecoderError &e) {
+    return (e.error_code() ? e.error_string() : std::string{"decoder error"});
+}
+}  // namespace
+
+struct DecoderFactory {
+    // Decodes up to the first frame. Every packet read on the way is kept in `pkts` so it can be
+    // replayed afterwards.
+    static bool trial_decode(Decoder &dec, std::vector<AVPacketPtr> &pkts) {
+        AVFramePtr frame{av_frame_alloc()};
+        if (!frame) {
+            throw std::runtime_error("Failed to allocate av_frame.");
+        }
+
+        bool drained = false;
+        while (!dec.receive_frame(frame.get())) {
+            if (drained || static_cast<int>(pkts.size()) >= TRIAL_PACKETS) {
+                return false;
+            }
+
+            AVPacketPtr pkt{av_packet_alloc()};
+            if (!pkt) {
+                throw std::runtime_error("Failed to allocate av_packet.");
+            }
+
+            if (dec.read_packet(pkt.get())) {
+                dec.send_packet(pkt.get());
+                pkts.push_back(std::move(pkt));
+            } else {
+                dec.send_packet(nullptr);
+                drained = true;
+            }
+        }
+
+        return true;
+    }
+
+    static OpenedDecoder open_hw(const std::string &url, const DecoderSetup &setup,
+        std::unique_ptr<Decoder> &opened, std::vector<AVPacketPtr> &pkts, std::string &reason) {
+        std::unique_ptr<Decoder> hw;
+        try {
+            hw = std::make_unique<HwDecoder>();
+        } catch (const std::exception &e) {
+            reason = e.what();
+            return {};
+        }
+
+        if (setup) {
+            setup(*hw);
+        }
+
+        // Failing to open the input is not something a software decoder would fix
+        hw->open_demuxer(url);
+        opened = std::move(hw);
+
+        try {
+            opened->setup_codec();
+            if (trial_decode(*opened, pkts)) {
+                avcodec_flush_buffers(opened->codec_context());
+                opened->replay_packets(std::move(pkts));
+
+                return {std::move(opened), {DecoderPath::HARDWARE, "decoded a trial frame"}};
+            }
+
+            reason = "no frame out of " + std::to_string(pkts.size()) + " trial packets";
+        } catch (const DecoderError &e) {
+            reason = describe(e);
+        } catch (const std::exception &e) {
+            reason = e.what();
+        }
+
+        return {};
+    }
+
+    static OpenedDecoder open(
+        const std::string &url, DecoderPreference pref, const DecoderSetup &setup) {
+        std::unique_ptr<Decoder> hw;
+        std::vector<AVPacketPtr> pkts;
+        std::string reason = "software decoding requested";
+
+        if (pref != DecoderPreference::SOFTWARE) {
+            auto opened = open_hw(url, setup, hw, pkts, reason);
+            if (opened.decoder) {
+                return opened;
+            }
+
+            if (pref == DecoderPreference::HARDWARE) {
+                Log(Log::ERROR) << "Hardware decoding of " << url << " failed: " << reason;
+                throw DecoderError(DecoderErrorDesc::FAILURE);
+            }
+
+            reason = "hardware decoding unavailable: " + reason;
+        }
+
+        std::unique_ptr<Decoder> sw = std::make_unique<SwDecoder>();
+        if (setup) {
+            setup(*sw);
+        }
+
+        if (hw) {
+            sw->adopt_input(*hw);
+            hw.reset();
+            sw->setup_codec();
+            sw->replay_packets(std::move(pkts));
+        } else {
+            sw->open_input(url);
+        }
+
+        return {std::move(sw), {DecoderPath::SOFTWARE, std::move(reason)}};
+    }
+};
+
+OpenedDecoder open_decoder(
+    const std::string &url, DecoderPreference pref, const DecoderSetup &setup) {
+    auto opened = DecoderFactory::open(url, pref, setup);
+    const auto threading = opened.decoder->active_threading();
+
+    SPLAYER_LOG(INFO) << "Decoding " << url << " with " << opened.decoder->name() << " decoder ("
+                      << opened.choice.reason << "), " << threading.threads << ' '
+                      << thread_type_name(threading.type) << " threads";
+    return opened;
+}
+
+const char *decoder_path_name(DecoderPath p) noexcept {
+    switch (p) {
+        case DecoderPath::HARDWARE:
+            return "hardware";
+        case DecoderPath::SOFTWARE:
+            return "software";
+    }
+
+    return "unknown";
+}
+}  // namespace splayer
@@ -0,0 +1,68 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef DECODER_FACTORY_H_
+#define DECODER_FACTORY_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "decoder.h"
+
+namespace splayer {
+enum class DecoderPreference {
+    // Hardware when it decodes the clip, software otherwise
+    AUTO,
+    // Hardware only, failing to open otherwise
+    HARDWARE,
+    SOFTWARE
+};
+
+enum class DecoderPath { HARDWARE, SOFTWARE };
+
+struct DecoderChoice {
+    DecoderPath path{DecoderPath::SOFTWARE};
+    // Why this path was taken, for logs and reports
+    std::string reason;
+};
+
+struct OpenedDecoder {
+    std::unique_ptr<Decoder> decoder;
+    DecoderChoice choice;
+};
+
+using DecoderSetup = std::function<void(Decoder &)>;
+
+// Opens `url` with a decoder for `pref`. `setup` runs on every decoder tried before it opens the
+// input, i.e. it is where `set_probe_cache`, `set_input_io` and friends go.
+//
+// With AUTO the hardware decoder has to produce its first frame before it is kept. If it can't,
+// the already opened input is handed over to a software decoder instead of being opened and
+// probed again, and the packets read while trying are decoded anew by it.
+OpenedDecoder open_decoder(
+    const std::string &url, DecoderPreference pref, const DecoderSetup &setup = {});
+
+const char *decoder_path_name(DecoderPath p) noexcept;
+}  // namespace splayer
+
+#endif /* DECODER_FACTORY_H_ */
@@ -0,0 +1,319 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "frame_converter.h"
+
+extern "C" {
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+}
+
+#include <splayer/util/profiler.h>
+#include <splayer/util/utils.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "decoder.h"
+
+using namespace utils;
+
+namespace splayer {
+namespace {
+// The range is left to the caller, it is whatever the conversion produced.
+void copy_frame_props(AVFrame *dst, const AVFrame *src) noexcept {
+    dst->pts = src->pts;
+    dst->best_effort_timestamp = src->best_effort_timestamp;
+    dst->colorspace = src->colorspace;
+}
+
+bool is_rgb(int fmt) noexcept {
+    const auto *desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(fmt));
+    return (desc && (desc->flags & AV_PIX_FMT_FLAG_RGB));
+}
+
+// RGB is always full range, YUV as tagged
+bool full_range(const AVFrame *f) noexcept {
+    return (is_rgb(f->format) || color_range_of(f) == graphics::ColorRange::FULL);
+}
+
+// Range of what swscale writes for `src`: full for RGB, YUV output keeps the source's range.
+bool full_range_out(const AVFrame *src, AVPixelFormat dst_fmt) noexcept {
+    return (is_rgb(dst_fmt) || full_range(src));
+}
+
+int sws_colorspace_of(graphics::ColorStandard s) noexcept {
+    switch (s) {
+        case graphics::ColorStandard::BT601:
+            return SWS_CS_ITU601;
+        case graphics::ColorStandard::BT709:
+            return SWS_CS_ITU709;
+        case graphics::ColorStandard::BT2020:
+            return SWS_CS_BT2020;
+    }
+
+    return SWS_CS_DEFAULT;
+}
+
+// Left alone, swscale assumes BT.601 and derives the source range from the pixel format only
+// (full for YUVJ formats), whatever the frame is tagged with. Hands it the frame's matrix and
+// range instead. Setting the details rebuilds the context's tables, so that only happens when
+// the context was just (re)built or the tags changed.
+void set_color_details(SwsContext *ctx, const AVFrame *src, bool dst_full) noexcept {
+    const int *coefs = sws_getCoefficients(sws_colorspace_of(color_standard_of(src)));
+    const int src_full = (full_range(src) ? 1 : 0);
+    const int dst_range = (dst_full ? 1 : 0);
+
+    int *cur_inv{nullptr};
+    int *cur_table{nullptr};
+    int cur_src_range{}, cur_dst_range{};
+    int brightness{0}, contrast{1 << 16}, saturation{1 << 16};
+    const int ret = sws_getColorspaceDetails(ctx, &cur_inv, &cur_src_range, &cur_table,
+        &cur_dst_range, &brightness, &contrast, &saturation);
+
+    if (ret >= 0 && cur_src_range == src_full && cur_dst_range == dst_range &&
+        std::equal(coefs, coefs + 4, cur_inv)) {
+        return;
+    }
+
+    sws_setColorspaceDetails(ctx, coefs, src_full, coefs, dst_range, brightness, contrast,
+        saturation);
+}
+
+// Luma row at which slice `i` of `n` starts, a multiple of `align` so no chroma row is split.
+int slice_start(int height, std::size_t i, std::size_t n, int align) noexcept {
+    if (i >= n) {
+        return height;
+    }
+
+    const auto row = static_cast<std::int64_t>(height) * static_cast<std::int64_t>(i) /
+                     static_cast<std::int64_t>(n);
+    return static_cast<int>(row) & ~(align - 1);
+}
+
+int chroma_align(AVPixelFormat a, AVPixelFormat b) noexcept {
+    const auto *da = av_pix_fmt_desc_get(a);
+    const auto *db = av_pix_fmt_desc_get(b);
+    const int shift_a = (da ? da->log2_chroma_h : 0);
+    const int shift_b = (db ? db->log2_chroma_h : 0);
+
+    return 1 << std::max(shift_a, shift_b);
+}
+
+// Plane pointers of `f` advanced to luma row `row`
+template <typename T>
+std::array<T *, 4> planes_at(const AVFrame *f, int row) noexcept {
+    const auto *desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(f->format));
+    std::array<T *, 4> planes{};
+
+    for (std::size_t p = 0; p < planes.size(); ++p) {
+        if (!f->data[p]) {
+            continue;
+        }
+
+        const int shift = ((p == 1 || p == 2) && desc ? desc->log2_chroma_h : 0);
+        planes[p] = f->data[p] + static_cast<std::ptrdiff_t>(row >> shift) * f->linesize[p];
+    }
+
+    return planes;
+}
+}  // namespace
+
+FrameConverter::FrameConverter(int flags) : sws_flags(flags) {}
+
+std::tuple<int, int> FrameConverter::fit_size(int w, int h, int box_w, int box_h) noexcept {
+    if (w <= 0 || h <= 0) {
+        return {box_w & ~1, box_h & ~1};
+    }
+
+    const double s =
+        std::min({1.0, static_cast<double>(box_w) / w, static_cast<double>(box_h) / h});
+    return {std::max(static_cast<int>(w * s) & ~1, 2), std::max(static_cast<int>(h * s) & ~1, 2)};
+}
+
+void FrameConverter::set_slices(std::size_t n) {
+    slices = std::max<std::size_t>(n, 1);
+    slice_pool = (slices > 1 ? std::make_unique<ThreadPool>(slices - 1) : nullptr);
+}
+
+bool FrameConverter::is_display_yuv(int fmt) noexcept {
+    switch (fmt) {
+        case AV_PIX_FMT_YUV420P:
+        case AV_PIX_FMT_YUVJ420P:
+        case AV_PIX_FMT_NV12:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool FrameConverter::resizes(const AVFrame *src) const noexcept {
+    return (out_width > 0 && out_height > 0 &&
+            (src->width != out_width || src->height != out_height));
+}
+
+PooledFramePtr FrameConverter::convert(const AVFrame *src) {
+    const bool resize = resizes(src);
+
+    if (target == CnvtTarget::YUV) {
+        if (is_display_yuv(src->format) && !resize) {
+            return passthrough(src);
+        }
+
+        return scale(src, AV_PIX_FMT_YUV420P);
+    }
+
+    if (const auto layout = yuv_layout_of(src->format); layout && prefer_native && !resize) {
+        return yuv_to_rgb(src, *layout);
+    }
+
+    return scale(src, AV_PIX_FMT_RGB24);
+}
+
+PooledFramePtr FrameConverter::passthrough(const AVFrame *src) {
+    auto dst = ref_pool.acquire();
+    if (!dst) {
+        return dst;
+    }
+
+    const int ret = av_frame_ref(dst.get(), src);
+    if (ret < 0) {
+        Log(Log::ERROR) << "Failed to reference decoded frame.";
+        throw DecoderError(DecoderErrorDesc::FAILURE, ret);
+    }
+
+    ref_pool.charge(dst);
+
+    return dst;
+}
+
+PooledFramePtr FrameConverter::scale(const AVFrame *src, AVPixelFormat dst_fmt) {
+    const bool resize = resizes(src);
+    auto dst = cnvt_pool.acquire(
+        dst_fmt, resize ? out_width : src->width, resize ? out_height : src->height);
+    if (!dst) {
+        return dst;
+    }
+
+    // Slices map source rows one to one onto destination rows, which scaling doesn't
+    const int align = chroma_align(static_cast<AVPixelFormat>(src->format), dst_fmt);
+    const auto n_slices = (resize ? 1 : slice_count(src->height, align));
+
+    setup_cnvt_process(src, dst.get(), n_slices, align);
+
+    {
+        PROF_ZONE(SWS_SCALE);
+        run_slices(n_slices, src->height, align, [&](std::size_t i, int beg, int end) {
+            const auto in = planes_at<const std::uint8_t>(src, beg);
+            const auto out = planes_at<std::uint8_t>(dst.get(), beg);
+            sws_scale(sws_ctxs[i], in.data(), src->linesize, 0, end - beg, out.data(),
+                dst->linesize);
+        });
+    }
+
+    copy_frame_props(dst.get(), src);
+    dst->color_range = (full_range_out(src, dst_fmt) ? AVCOL_RANGE_JPEG : AVCOL_RANGE_MPEG);
+
+    return dst;
+}
+
+PooledFramePtr FrameConverter::yuv_to_rgb(const AVFrame *src, YuvLayout layout) {
+    auto dst = cnvt_pool.acquire(AV_PIX_FMT_RGB24, src->width, src->height);
+    if (!dst) {
+        return dst;
+    }
+
+    const auto standard = color_standard_of(src);
+    const auto range = color_range_of(src);
+    if (!native_cnvt || standard != native_standard || range != native_range) {
+        native_cnvt.emplace(standard, range);
+        native_standard = standard;
+        native_range = range;
+    }
+
+    const auto img = yuv_image_of(src, layout);
+    const RgbImage out{dst->data[0], dst->linesize[0], RgbLayout::RGB24};
+    constexpr int align = 2;
+
+    {
+        PROF_ZONE(YUV_TO_RGB);
+        run_slices(slice_count(src->height, align), src->height, align,
+            [&](std::size_t, int beg, int end) { native_cnvt->convert(img, out, beg, end); });
+    }
+
+    copy_frame_props(dst.get(), src);
+    dst->color_range = AVCOL_RANGE_JPEG;
+
+    return dst;
+}
+
+std::size_t FrameConverter::slice_count(int height, int align) const noexcept {
+    return std::clamp<std::size_t>(static_cast<std::size_t>(height / align), 1, slices);
+}
+
+template <typename Fn>
+void FrameConverter::run_slices(std::size_t n_slices, int height, int align, Fn &&fn) {
+    if (n_slices == 1 || !slice_pool) {
+        fn(0, 0, height);
+        return;
+    }
+
+    slice_pool->run(n_slices, [&](std::size_t i) {
+        fn(i, slice_start(height, i, n_slices, align), slice_start(height, i + 1, n_slices, align));
+    });
+}
+
+void FrameConverter::setup_cnvt_process(
+    const AVFrame *src, const AVFrame *dst, std::size_t n_slices, int align) {
+    const auto dst_fmt = static_cast<AVPixelFormat>(dst->format);
+    const bool dst_full = full_range_out(src, dst_fmt);
+
+    if (sws_ctxs.size() < n_slices) {
+        sws_ctxs.resize(n_slices, nullptr);
+    }
+
+    for (std::size_t i = 0; i < n_slices; ++i) {
+        const int h = slice_start(src->height, i + 1, n_slices, align) -
+                      slice_start(src->height, i, n_slices, align);
+
+        // Returns the current context untouched unless the stream changed resolution or pixel
+        // format mid-file, in which case it is rebuilt.
+        const int dst_h = (n_slices == 1 ? dst->height : h);
+        sws_ctxs[i] = sws_getCachedContext(sws_ctxs[i], src->width, h,
+            static_cast<AVPixelFormat>(src->format), dst->width, dst_h, dst_fmt, sws_flags, nullptr,
+            nullptr, nullptr);
+        if (!sws_ctxs[i]) {
+            Log(Log::ERROR) << "Failed to create conversion context.";
+            throw DecoderError(DecoderErrorDesc::FAILURE);
+        }
+
+        set_color_details(sws_ctxs[i], src, dst_full);
+    }
+}
+
+FrameConverter::~FrameConverter() {
+    for (auto *ctx : sws_ctxs) {
+        sws_freeContext(ctx);
+    }
+}
+}  // namespace splayer
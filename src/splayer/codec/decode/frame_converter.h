@@ -0,0 +1,128 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FRAME_CONVERTER_H_
+#define FRAME_CONVERTER_H_
+
+#include <splayer/codec/convert/yuv_rgb.h>
+#include <splayer/util/thread_pool.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+#include "frame_pool.h"
+
+struct SwsContext;
+
+namespace splayer {
+enum class CnvtTarget {
+    // Packed RGB24, converted on the CPU.
+    RGB24,
+    // Planar YUV420P or semi-planar NV12, colour conversion is left to the display shader.
+    YUV
+};
+
+// Conversion stage shared by the decoders. Frames that are already in a displayable YUV layout
+// are passed through by reference. RGB output from the common YUV layouts uses the native SIMD
+// kernels, everything else goes through swscale into a pooled buffer. Either can be split into
+// horizontal slices converted in parallel.
+class FrameConverter final {
+public:
+    explicit FrameConverter(int sws_flags);
+    FrameConverter(const FrameConverter &) = delete;
+    FrameConverter &operator=(const FrameConverter &) = delete;
+    ~FrameConverter();
+
+    // Must not be changed while frames are being converted.
+    void set_target(CnvtTarget t) noexcept { target = t; }
+    CnvtTarget get_target() const noexcept { return target; }
+
+    // Converts each frame as `n` horizontal slices, on `n - 1` pool workers plus the calling
+    // thread. Must not be changed while frames are being converted.
+    void set_slices(std::size_t n);
+    std::size_t get_slices() const noexcept { return slices; }
+    // See `FramePool::buffer_allocations`
+    std::uint64_t buffer_allocations() const noexcept { return cnvt_pool.buffer_allocations(); }
+    // Converted frames not yet handed back, the converter must outlive them.
+    std::size_t frames_out() const noexcept {
+        return (cnvt_pool.capacity() - cnvt_pool.available()) +
+               (ref_pool.capacity() - ref_pool.available());
+    }
+
+    // Scales every frame to `width` x `height` on the way, 0 x 0 keeps the decoded size. Resized
+    // frames always go through swscale in a single slice. Must not be changed while frames are
+    // being converted.
+    void set_output_size(int width, int height) noexcept {
+        out_width = width;
+        out_height = height;
+    }
+    // Largest output size within `box_w` x `box_h` with the aspect ratio of `w` x `h`, never
+    // upscaled and even for the 4:2:0 chroma planes. The box itself when `w` x `h` is unknown.
+    static std::tuple<int, int> fit_size(int w, int h, int box_w, int box_h) noexcept;
+
+    // Routes everything through swscale when false, e.g. to compare the two.
+    void set_native_cnvt(bool enable) noexcept { prefer_native = enable; }
+
+    PooledFramePtr convert(const AVFrame *src);
+
+    static bool is_display_yuv(int fmt) noexcept;
+
+private:
+    bool resizes(const AVFrame *src) const noexcept;
+    PooledFramePtr passthrough(const AVFrame *src);
+    PooledFramePtr scale(const AVFrame *src, AVPixelFormat dst_fmt);
+    PooledFramePtr yuv_to_rgb(const AVFrame *src, YuvLayout layout);
+    void setup_cnvt_process(
+        const AVFrame *src, const AVFrame *dst, std::size_t n_slices, int align);
+
+    std::size_t slice_count(int height, int align) const noexcept;
+    // Calls `fn(i, beg, end)` for every slice of rows [beg, end), in parallel when slicing
+    template <typename Fn>
+    void run_slices(std::size_t n_slices, int height, int align, Fn &&fn);
+
+    static constexpr auto CNVT_POOL_SIZE = 8;
+
+    FramePool cnvt_pool{CNVT_POOL_SIZE, FramePool::Mode::OWNED_BUFFERS};
+    FramePool ref_pool{CNVT_POOL_SIZE, FramePool::Mode::REFERENCE};
+
+    // Rebuilt when the colour description of the stream changes
+    std::optional<YuvToRgb> native_cnvt;
+    graphics::ColorStandard native_standard{};
+    graphics::ColorRange native_range{};
+
+    // One context per slice, each sized to its slice
+    std::vector<SwsContext *> sws_ctxs;
+    int sws_flags;
+    CnvtTarget target{CnvtTarget::RGB24};
+    bool prefer_native{true};
+    int out_width{}, out_height{};
+
+    std::size_t slices{1};
+    std::unique_ptr<utils::ThreadPool> slice_pool;
+};
+}  // namespace splayer
+
+#endif /* FRAME_CONVERTER_H_ */
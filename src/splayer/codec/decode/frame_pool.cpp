@@ -0,0 +1,129 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "frame_pool.h"
+
+#include <splayer/util/memory_budget.h>
+#include <splayer/util/utils.h>
+
+#include <stdexcept>
+
+#include "decoder.h"
+
+using namespace utils;
+
+namespace splayer {
+void FramePoolReleaser::operator()(AVFrame *f) const noexcept {
+    if (pool != nullptr) {
+        pool->release(f, slot);
+    }
+}
+
+FramePool::FramePool(std::size_t count, Mode m) : mode(m), charged(count), free_list(count) {
+    frames.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        frames.emplace_back(av_frame_alloc());
+        if (!frames.back()) {
+            throw std::runtime_error("Failed to allocate av_frame.");
+        }
+
+        free_list.try_push(i);
+    }
+}
+
+PooledFramePtr FramePool::acquire() noexcept {
+    std::size_t slot{};
+
+    if (!free_list.try_pop(slot)) {
+        return {};
+    }
+
+    borrowed.fetch_add(1, std::memory_order_relaxed);
+    return PooledFramePtr{frames[slot].get(), FramePoolReleaser{this, slot}};
+}
+
+PooledFramePtr FramePool::acquire(AVPixelFormat fmt, int width, int height) {
+    ASSERT(mode == Mode::OWNED_BUFFERS);
+
+    auto f = acquire();
+    if (!f) {
+        return f;
+    }
+
+    // Buffers are only (re)allocated while warming up or when the geometry changes.
+    if (f->buf[0] == nullptr || f->format != fmt || f->width != width || f->height != height) {
+        av_frame_unref(f.get());
+
+        f->format = fmt;
+        f->width = width;
+        f->height = height;
+
+        const int ret = av_frame_get_buffer(f.get(), FRAME_BUF_ALIGNMENT);
+        if (ret < 0) {
+            Log(Log::ERROR) << "Failed to allocate pooled frame buffer.";
+            throw DecoderError(DecoderErrorDesc::FAILURE, ret);
+        }
+
+        buffer_allocs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    charge(f);
+    return f;
+}
+
+void FramePool::charge(const PooledFramePtr &f) noexcept {
+    const auto slot = f.get_deleter().slot;
+    uncharge(slot);
+
+    // Keyed by the underlying buffer, a passed through decoded frame shares it with its source
+    auto &c = charged[slot];
+    for (std::size_t i = 0; i < c.size(); ++i) {
+        const auto *b = f->buf[i];
+        c[i] = (b != nullptr ? b->buffer : nullptr);
+        if (b != nullptr) {
+            MemoryBudget::charge_shared(b->buffer, b->size);
+        }
+    }
+}
+
+void FramePool::uncharge(std::size_t slot) noexcept {
+    for (auto &b : charged[slot]) {
+        if (b != nullptr) {
+            MemoryBudget::release_shared(b);
+            b = nullptr;
+        }
+    }
+}
+
+void FramePool::release(AVFrame *f, std::size_t slot) noexcept {
+    uncharge(slot);
+
+    if (mode == Mode::REFERENCE) {
+        av_frame_unref(f);
+    }
+
+    // Can't overflow, only frames handed out by this pool come back to it.
+    free_list.try_push(slot);
+    borrowed.fetch_sub(1, std::memory_order_release);
+}
+}  // namespace splayer
@@ -0,0 +1,105 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FRAME_POOL_H_
+#define FRAME_POOL_H_
+
+#include <splayer/util/mpsc_queue.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "av_ptr.h"
+
+namespace splayer {
+class FramePool;
+
+struct FramePoolReleaser {
+    FramePool *pool{nullptr};
+    // Index of the frame in its pool
+    std::size_t slot{};
+    void operator()(AVFrame *f) const noexcept;
+};
+
+// A frame borrowed from a `FramePool`; going out of scope hands it back to the pool, releasing
+// whatever it was charged to `utils::MemoryBudget`.
+using PooledFramePtr = std::unique_ptr<AVFrame, FramePoolReleaser>;
+
+// Fixed set of preallocated `AVFrame`s recycled through a lock-free free list, so that the steady
+// state decode path never touches the heap. One thread acquires at a time, any thread may release:
+// frames come back from the consumer as well as from whoever drops them on teardown.
+class FramePool final {
+public:
+    enum class Mode {
+        // Frames are filled by someone else (e.g. `avcodec_receive_frame`), their references are
+        // dropped on release.
+        REFERENCE,
+        // Frames own an image buffer that survives release and is reused by the next acquire as
+        // long as the requested geometry matches, otherwise it is reallocated to the new one.
+        OWNED_BUFFERS
+    };
+
+    FramePool(std::size_t count, Mode mode);
+    FramePool(const FramePool &) = delete;
+    FramePool &operator=(const FramePool &) = delete;
+    ~FramePool() = default;
+
+    // Returns an empty pointer when every frame is currently borrowed.
+    PooledFramePtr acquire() noexcept;
+    // Charges the frame's buffer to `utils::MemoryBudget` until it's released.
+    PooledFramePtr acquire(AVPixelFormat fmt, int width, int height);
+    // Charges the buffers a REFERENCE frame was just filled with to `utils::MemoryBudget` until
+    // it's released. Buffers other pooled frames already hold are only counted once.
+    void charge(const PooledFramePtr &f) noexcept;
+
+    std::size_t capacity() const noexcept { return frames.size(); }
+    std::size_t available() const noexcept {
+        return frames.size() - borrowed.load(std::memory_order_acquire);
+    }
+    // Image buffers allocated by `acquire` so far, flat once the pool is warmed up
+    std::uint64_t buffer_allocations() const noexcept {
+        return buffer_allocs.load(std::memory_order_relaxed);
+    }
+
+private:
+    friend FramePoolReleaser;
+    void release(AVFrame *f, std::size_t slot) noexcept;
+    void uncharge(std::size_t slot) noexcept;
+
+    static constexpr auto FRAME_BUF_ALIGNMENT = 32;
+
+    Mode mode;
+    std::vector<AVFramePtr> frames;
+    // Buffers charged per frame, written by the acquiring and read by the releasing thread
+    std::vector<std::array<const AVBuffer *, AV_NUM_DATA_POINTERS>> charged;
+    // Slots of the frames not borrowed
+    utils::MpscQueue<std::size_t> free_list;
+    std::atomic<std::size_t> borrowed{};
+    std::atomic<std::uint64_t> buffer_allocs{};
+};
+}  // namespace splayer
+
+#endif /* FRAME_POOL_H_ */
@@ -22,20 +22,25 @@
 
 #include "hw_decode.h"
 
+#include <splayer/util/profiler.h>
 #include <splayer/util/utils.h>
 
 using namespace utils;
 
 namespace splayer {
-HwDecoder::HwDecoder() {
+HwDecoder::HwDecoder() : Decoder(SWS_BICUBIC) {
     frame.reset(av_frame_alloc());
-    frame_cnvt.reset(av_frame_alloc());
     sw_frame.reset(av_frame_alloc());
+    pkt.reset(av_packet_alloc());
 
-    if (!frame || !frame_cnvt || !sw_frame) {
+    if (!frame || !sw_frame) {
         throw std::runtime_error("Failed to allocate av_frame.");
     }
 
+    if (!pkt) {
+        throw std::runtime_error("Failed to allocate av_packet.");
+    }
+
     AVHWDeviceType type{AV_HWDEVICE_TYPE_NONE};
     while (true) {
         type = av_hwdevice_iterate_types(type);
@@ -56,42 +61,19 @@ HwDecoder::HwDecoder() {
         throw std::runtime_error("Failed to find suitable hardware device for decoding.");
     }
 
-    Log(Log::INFO) << "Using hardware device " << av_hwdevice_get_type_name(hw_device_type_)
-                   << " for decoding.";
+    SPLAYER_LOG(INFO) << "Using hardware device " << av_hwdevice_get_type_name(hw_device_type_)
+                      << " for decoding.";
 }
 
-// TODO: In the event that failure happens further down, and we return, we fail to free/close a
-// bunch of contexts that were made
-void HwDecoder::open_input(const std::string &url) {
-    int ret{};
-
-    // Note: avformat_open_input will allocate our context for us.
-    ret = avformat_open_input(&format_ctx_, url.c_str(), nullptr, nullptr);
-    if (ret < 0) {
-        Log(Log::ERROR) << "Failed to open input stream and/or read the header of: " << url;
-        throw DecoderError(DecoderErrorDesc::FAILURE, ret);
-    }
-
-    ret = avformat_find_stream_info(format_ctx_, nullptr);
-    if (ret < 0) {
-        Log(Log::ERROR) << "Failed to read stream information.";
-        throw DecoderError(DecoderErrorDesc::FAILURE, ret);
-    }
+void HwDecoder::setup_codec() {
+    const auto *par = format_ctx_->streams[best_vid_stream_id_]->codecpar;
 
-    find_best_stream();
-}
-
-void HwDecoder::find_best_stream() {
-    int ret{};
-    
-    ret = av_find_best_stream(format_ctx_, AVMEDIA_TYPE_VIDEO, -1, -1, const_cast<const AVCodec **>(&codec_), 0);
-    if (ret < 0) {
-        Log(Log::ERROR) << "Failed to find valid stream/decoder.";
-        throw DecoderError(DecoderErrorDesc::FAILURE, ret);
+    codec_ = avcodec_find_decoder(par->codec_id);
+    if (!codec_) {
+        Log(Log::ERROR) << "Unsupported codec";
+        throw DecoderError(DecoderErrorDesc::FAILURE);
     }
 
-    best_vid_stream_id_ = ret;
-
     find_decoder();
 }
 
@@ -144,127 +126,94 @@ void HwDecoder::hw_decode_init() {
     }
 
     codec_ctx_->hw_device_ctx = av_buffer_ref(hw_device_ctx_);
+    apply_threading(codec_ctx_, codec_);
 
     err = avcodec_open2(codec_ctx_, codec_, nullptr);
     if (err < 0) {
         Log(Log::ERROR) << "Failed to open codec for stream " << best_vid_stream_id_;
         throw DecoderError(DecoderErrorDesc::FAILURE, err);
     }
-
-    // setup_cnvt_process();
-}
-
-bool HwDecoder::packet_is_from_video_stream(const AVPacket *p) const noexcept {
-    return (p->stream_index == best_vid_stream_id_);
 }
 
-AVPixelFormat found;
-bool flag{false};
-
-void HwDecoder::setup_cnvt_process(AVPixelFormat fmt) {
-    if (buf_size) {
-        return;
+void HwDecoder::send_packet(const AVPacket *p) {
+    int ret;
+    {
+        PROF_ZONE(SEND_PACKET);
+        ret = avcodec_send_packet(codec_ctx_, p);
     }
 
-    /*AVHWFramesConstraints *hw_frames_const =
-        av_hwdevice_get_hwframe_constraints(hw_device_ctx_, nullptr);
-    if (!hw_frames_const) {
-        Log(Log::ERROR) << "Failed to get hw frame constraints.";
-        throw DecoderError(DecoderErrorDesc::FAILURE);
+    if (ret < 0 && ret != AVERROR_EOF) {
+        Log(Log::ERROR) << "Error sending packet for decoding.";
+        throw DecoderError{DecoderErrorDesc::FAILURE, ret};
     }
+}
+
+bool HwDecoder::receive_frame(AVFrame *out) {
+    // Frames ahead of an exact seek target are dropped before paying for the transfer
+    while (true) {
+        int ret;
+        {
+            PROF_ZONE(RECEIVE_FRAME);
+            ret = avcodec_receive_frame(codec_ctx_, frame.get());
+        }
 
-    // Check if we can convert the pixel format to a readable format.
-    found = AV_PIX_FMT_NONE;
-    for (AVPixelFormat *p = hw_frames_const->valid_sw_formats; *p != AV_PIX_FMT_NONE; p++) {
-        // Check if we can convert to the desired format.
-        if (sws_isSupportedInput(*p)) {
-            // Ok! This format can be used with swscale!
-            found = *p;
-            std::cout << av_get_pix_fmt_name(found) << '\n';
-            // break;
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+            return false;
+        } else if (ret < 0) {
+            Log(Log::ERROR) << "Error while decoding.";
+            throw DecoderError{DecoderErrorDesc::FAILURE, ret};
         }
+
+        if (!before_seek_target(frame.get())) {
+            break;
+        }
+
+        av_frame_unref(frame.get());
     }
 
-    // Don't forget to free the constraint object.
-    av_hwframe_constraints_free(&hw_frames_const);*/
+    av_frame_unref(out);
 
-    buf_size = av_image_get_buffer_size(
-        AV_PIX_FMT_RGB24, codec_ctx_->width, codec_ctx_->height, FRAME_BUF_ALIGNMENT);
-    cnvt_buf = static_cast<std::uint8_t *>(av_malloc(buf_size * sizeof(std::uint8_t)));
+    int err;
+    {
+        PROF_ZONE(HWFRAME_TRANSFER);
+        err = av_hwframe_transfer_data(out, frame.get(), 0);
+    }
+    if (err < 0) {
+        Log(Log::ERROR) << "Error while tranferring data to system memory." << err;
+        throw DecoderError{DecoderErrorDesc::FAILURE, err};
+    }
 
-    av_image_fill_arrays(frame_cnvt->data, frame_cnvt->linesize, cnvt_buf, AV_PIX_FMT_RGB24,
-        codec_ctx_->width, codec_ctx_->height, FRAME_BUF_ALIGNMENT);
+    av_frame_copy_props(out, frame.get());
+    av_frame_unref(frame.get());
 
-    sws_ctx = sws_getContext(codec_ctx_->width, codec_ctx_->height, fmt, codec_ctx_->width,
-        codec_ctx_->height, AV_PIX_FMT_RGB24, SWS_BICUBIC, nullptr, nullptr, nullptr);
+    return true;
 }
 
-AVFrame *HwDecoder::decode_frame() {
-    AVPacket pkt{};
-    int ret{};
-
-    while (av_read_frame(format_ctx_, &pkt) >= 0) {
-        if (packet_is_from_video_stream(&pkt)) {
-            ret = avcodec_send_packet(codec_ctx_, &pkt);
-            if (ret < 0) {
-                Log(Log::ERROR) << "Error sending packet for decoding.";
-                throw DecoderError{DecoderErrorDesc::FAILURE, ret};
-            }
-
-            bool frm_success = (ret >= 0);
-
-            while (frm_success) {
-                ret = avcodec_receive_frame(codec_ctx_, frame.get());
-
-                if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-                    break;
-                } else if (ret < 0) {
-                    Log(Log::ERROR) << "Error while decoding.";
-                    throw DecoderError{DecoderErrorDesc::FAILURE, ret};
-                }
-
-                const auto err = av_hwframe_transfer_data(sw_frame.get(), frame.get(), 0);
-                if (err < 0) {
-                    Log(Log::ERROR) << "Error while tranferring data to system memory." << err;
-                    throw DecoderError{DecoderErrorDesc::FAILURE, err};
-                }
-
-                /*std::cout << av_get_pix_fmt_name(static_cast<AVPixelFormat>(sw_frame->format))
-                          << '\n';*/
-
-                if (!flag) {
-                    flag = true;
-                    setup_cnvt_process(static_cast<AVPixelFormat>(sw_frame->format));
-                }
-
-                sws_scale(sws_ctx, static_cast<const uint8_t *const *>(sw_frame->data),
-                    sw_frame->linesize, 0, sw_frame->height, frame_cnvt->data,
-                    frame_cnvt->linesize);
-
-                frame_cnvt->width = codec_ctx_->width;
-                frame_cnvt->height = codec_ctx_->height;
-                frame_cnvt->format = sw_frame->format;
-
-                return frame_cnvt.get();
-            }
-
-            if (frm_success) {
-                break;
-            }
+PooledFramePtr HwDecoder::decode_frame() {
+    while (!receive_frame(sw_frame.get())) {
+        if (!read_packet(pkt.get())) {
+            return {};
         }
+
+        send_packet(pkt.get());
+        av_packet_unref(pkt.get());
     }
 
-    return nullptr;
+    auto f = convert_frame(sw_frame.get());
+    if (!f) {
+        Log(Log::ERROR) << "Every pooled frame is still held by a consumer.";
+        throw DecoderError(DecoderErrorDesc::FAILURE);
+    }
+
+    return f;
 }
 
-double HwDecoder::clip_fps() const noexcept {
-    return av_q2d(format_ctx_->streams[best_vid_stream_id_]->r_frame_rate);
+std::string HwDecoder::name() const {
+    return std::string{"hw ("} + av_hwdevice_get_type_name(hw_device_type_) + ")";
 }
 
 HwDecoder::~HwDecoder() {
-    av_free(cnvt_buf);
     avcodec_free_context(&codec_ctx_);
-
-    cnvt_buf = nullptr;
+    av_buffer_unref(&hw_device_ctx_);
 }
 }  // namespace splayer
\ No newline at end of file
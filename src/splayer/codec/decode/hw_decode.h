@@ -23,6 +23,8 @@
 #ifndef HW_DECODE_H_
 #define HW_DECODE_H_
 
+#include <string>
+
 #include "decoder.h"
 
 extern "C" {
@@ -38,39 +40,30 @@ public:
     HwDecoder();
     virtual ~HwDecoder() override;
 
-    void open_input(const std::string &url) override;
+    void send_packet(const AVPacket *pkt) override;
+    bool receive_frame(AVFrame *out) override;
+    PooledFramePtr decode_frame() override;
+
+    std::string name() const override;
 
-    AVFrame *decode_frame();
-    double clip_fps() const noexcept;
+protected:
+    void setup_codec() override;
+    AVCodecContext *codec_context() noexcept override { return codec_ctx_; }
 
 private:
-    void find_best_stream();
     void find_decoder();
     int get_decoder_id() noexcept;
     void setup_decoder();
     void hw_decode_init();
 
-    bool packet_is_from_video_stream(const AVPacket *p) const noexcept;
-
-    void setup_cnvt_process(AVPixelFormat fmt);
-
     AVHWDeviceType hw_device_type_{AV_HWDEVICE_TYPE_NONE};
-    AVFormatContext *format_ctx_{nullptr};
-    AVCodec *codec_;
+    const AVCodec *codec_{nullptr};
     AVPixelFormat hw_pix_type_{};
     AVCodecContext *codec_ctx_{nullptr};
     AVBufferRef *hw_device_ctx_{nullptr};
 
-    AVFramePtr frame, frame_cnvt, sw_frame;
-
-    SwsContext *sws_ctx{nullptr};
-
-    int best_vid_stream_id_{-1};
-    int buf_size{};
-
-    std::uint8_t *cnvt_buf{nullptr};
-
-    static constexpr auto FRAME_BUF_ALIGNMENT = 32;
+    AVFramePtr frame, sw_frame;
+    AVPacketPtr pkt;
 };
 }  // namespace splayer
 
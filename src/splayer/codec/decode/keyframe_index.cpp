@@ -0,0 +1,144 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "keyframe_index.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/avutil.h>
+}
+
+#include <algorithm>
+#include <utility>
+
+namespace splayer {
+void KeyframeIndex::add_packet(const AVPacket *pkt) {
+    const auto ts = (pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts);
+    if (ts == AV_NOPTS_VALUE) {
+        return;
+    }
+
+    if (!in_span) {
+        cur_span = {ts, ts};
+        in_span = true;
+    }
+
+    // Reordered frames can come in below the span start, the keyframe opening it cannot
+    cur_span.end = std::max(cur_span.end, ts);
+
+    if (!(pkt->flags & AV_PKT_FLAG_KEY) || ts < cur_span.beg) {
+        return;
+    }
+
+    const auto it = std::lower_bound(keyframes.begin(), keyframes.end(), ts,
+        [](const Entry &e, std::int64_t v) { return e.pts < v; });
+    if (it == keyframes.end() || it->pts != ts) {
+        keyframes.insert(it, Entry{ts, pkt->dts, pkt->pos});
+    }
+}
+
+void KeyframeIndex::break_span() noexcept {
+    if (!in_span) {
+        return;
+    }
+
+    in_span = false;
+
+    auto it = std::lower_bound(spans.begin(), spans.end(), cur_span.beg,
+        [](const Span &s, std::int64_t v) { return s.end < v; });
+
+    // Swallow every span the new one touches
+    auto merged = cur_span;
+    auto last = it;
+    while (last != spans.end() && last->beg <= merged.end) {
+        merged.beg = std::min(merged.beg, last->beg);
+        merged.end = std::max(merged.end, last->end);
+        ++last;
+    }
+
+    it = spans.erase(it, last);
+    spans.insert(it, merged);
+}
+
+void KeyframeIndex::clear() noexcept {
+    keyframes.clear();
+    spans.clear();
+    in_span = false;
+}
+
+void KeyframeIndex::assign(std::vector<Entry> kfs, std::vector<Span> sps) {
+    const auto by_pts = [](const Entry &a, const Entry &b) { return a.pts < b.pts; };
+    const auto by_beg = [](const Span &a, const Span &b) { return a.beg < b.beg; };
+
+    keyframes = std::move(kfs);
+    spans = std::move(sps);
+    in_span = false;
+
+    // Saved indexes come from disk, don't trust them to be ordered
+    if (!std::is_sorted(keyframes.begin(), keyframes.end(), by_pts)) {
+        std::sort(keyframes.begin(), keyframes.end(), by_pts);
+    }
+
+    if (!std::is_sorted(spans.begin(), spans.end(), by_beg)) {
+        std::sort(spans.begin(), spans.end(), by_beg);
+    }
+
+    // Fold overlapping spans so lookups can rely on them being disjoint
+    std::vector<Span> merged;
+    for (const auto &sp : spans) {
+        if (!merged.empty() && sp.beg <= merged.back().end) {
+            merged.back().end = std::max(merged.back().end, sp.end);
+        } else {
+            merged.push_back(sp);
+        }
+    }
+
+    spans = std::move(merged);
+}
+
+std::optional<KeyframeIndex::Entry> KeyframeIndex::find(std::int64_t pts) const noexcept {
+    const auto covers = [pts](const Span &s) { return s.beg <= pts && pts <= s.end; };
+
+    std::optional<Span> span;
+    if (in_span && covers(cur_span)) {
+        span = cur_span;
+    } else {
+        const auto it = std::lower_bound(spans.begin(), spans.end(), pts,
+            [](const Span &s, std::int64_t v) { return s.end < v; });
+        if (it != spans.end() && covers(*it)) {
+            span = *it;
+        }
+    }
+
+    if (!span) {
+        return std::nullopt;
+    }
+
+    const auto it = std::upper_bound(keyframes.begin(), keyframes.end(), pts,
+        [](std::int64_t v, const Entry &e) { return v < e.pts; });
+    if (it == keyframes.begin() || std::prev(it)->pts < span->beg) {
+        return std::nullopt;
+    }
+
+    return *std::prev(it);
+}
+}  // namespace splayer
@@ -0,0 +1,77 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef KEYFRAME_INDEX_H_
+#define KEYFRAME_INDEX_H_
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+struct AVPacket;
+
+namespace splayer {
+// Keyframes of one stream seen while demuxing, along with the timestamp spans that were demuxed
+// without a gap. Inside such a span every keyframe is known, so the one a seek has to start
+// decoding from can be looked up instead of asking the demuxer to search for it.
+class KeyframeIndex final {
+public:
+    struct Entry {
+        std::int64_t pts;
+        std::int64_t dts;
+        // Byte offset in the input, -1 if unknown
+        std::int64_t pos;
+    };
+
+    struct Span {
+        std::int64_t beg;
+        std::int64_t end;
+    };
+
+    // Records a packet of the indexed stream. Packets must arrive in demux order.
+    void add_packet(const AVPacket *pkt);
+    // Ends the current span, the next packet starts a new one. Called on every seek.
+    void break_span() noexcept;
+    void clear() noexcept;
+    // Replaces the contents with a previously saved index of the same input.
+    void assign(std::vector<Entry> kfs, std::vector<Span> sps);
+
+    // Latest keyframe at or before `pts`, provided everything from it up to `pts` was demuxed
+    // already.
+    std::optional<Entry> find(std::int64_t pts) const noexcept;
+
+    std::size_t size() const noexcept { return keyframes.size(); }
+    const std::vector<Entry> &entries() const noexcept { return keyframes; }
+    // Closed spans only, the one still being demuxed is folded in by `break_span`.
+    const std::vector<Span> &closed_spans() const noexcept { return spans; }
+
+private:
+    // Both sorted, spans never overlap
+    std::vector<Entry> keyframes;
+    std::vector<Span> spans;
+
+    Span cur_span{};
+    bool in_span{false};
+};
+}  // namespace splayer
+
+#endif /* KEYFRAME_INDEX_H_ */
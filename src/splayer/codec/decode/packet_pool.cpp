@@ -0,0 +1,66 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "packet_pool.h"
+
+#include <stdexcept>
+
+namespace splayer {
+void PacketPoolReleaser::operator()(AVPacket *p) const noexcept {
+    if (pool != nullptr) {
+        pool->release(p);
+    }
+}
+
+PacketPool::PacketPool(std::size_t count) : free_list(count) {
+    packets.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        packets.emplace_back(av_packet_alloc());
+        if (!packets.back()) {
+            throw std::runtime_error("Failed to allocate av_packet.");
+        }
+
+        free_list.try_push(packets.back().get());
+    }
+}
+
+PooledPacketPtr PacketPool::acquire() noexcept {
+    AVPacket *p{nullptr};
+
+    if (!free_list.try_pop(p)) {
+        return {};
+    }
+
+    borrowed.fetch_add(1, std::memory_order_relaxed);
+    return PooledPacketPtr{p, PacketPoolReleaser{this}};
+}
+
+void PacketPool::release(AVPacket *p) noexcept {
+    // Drops the payload and side data, only the shell is reused
+    av_packet_unref(p);
+
+    // Can't overflow, only packets handed out by this pool come back to it.
+    free_list.try_push(p);
+    borrowed.fetch_sub(1, std::memory_order_release);
+}
+}  // namespace splayer
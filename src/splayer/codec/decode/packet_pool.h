@@ -0,0 +1,76 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PACKET_POOL_H_
+#define PACKET_POOL_H_
+
+#include <splayer/util/mpsc_queue.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "av_ptr.h"
+
+namespace splayer {
+class PacketPool;
+
+struct PacketPoolReleaser {
+    PacketPool *pool{nullptr};
+    void operator()(AVPacket *p) const noexcept;
+};
+
+// A packet borrowed from a `PacketPool`; going out of scope drops its payload reference and hands
+// the shell back to the pool.
+using PooledPacketPtr = std::unique_ptr<AVPacket, PacketPoolReleaser>;
+
+// Fixed set of preallocated `AVPacket` shells recycled through a lock-free free list, so the demux
+// loop doesn't allocate and free one per packet. One thread acquires at a time, any thread may
+// release: packets come back from the decode thread, and from the demux thread or the owner of the
+// queue when they drop theirs on teardown.
+class PacketPool final {
+public:
+    explicit PacketPool(std::size_t count);
+    PacketPool(const PacketPool &) = delete;
+    PacketPool &operator=(const PacketPool &) = delete;
+    ~PacketPool() = default;
+
+    // Returns an empty pointer when every packet is currently borrowed.
+    PooledPacketPtr acquire() noexcept;
+
+    std::size_t capacity() const noexcept { return packets.size(); }
+    std::size_t available() const noexcept {
+        return packets.size() - borrowed.load(std::memory_order_acquire);
+    }
+
+private:
+    friend PacketPoolReleaser;
+    void release(AVPacket *p) noexcept;
+
+    std::vector<AVPacketPtr> packets;
+    utils::MpscQueue<AVPacket *> free_list;
+    std::atomic<std::size_t> borrowed{};
+};
+}  // namespace splayer
+
+#endif /* PACKET_POOL_H_ */
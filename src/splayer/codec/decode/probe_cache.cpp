@@ -0,0 +1,364 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "probe_cache.h"
+
+#include <splayer/codec/io/input_io.h>
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+
+namespace fs = std::filesystem;
+
+namespace splayer {
+namespace {
+// Bump whenever the layout below changes, older sidecars are then ignored and rewritten.
+constexpr std::uint32_t PROBE_CACHE_VERSION = 2;
+constexpr std::array<char, 8> PROBE_CACHE_MAGIC{'S', 'P', 'P', 'R', 'O', 'B', 'E', '\0'};
+constexpr std::string_view PROBE_CACHE_SUFFIX = ".splayer-probe";
+
+// Integers are stored little endian whatever the host, a sidecar may sit on a shared volume.
+class Writer final {
+public:
+    template <typename T>
+    void put(T v) {
+        static_assert(std::is_integral_v<T>);
+        auto u = static_cast<std::make_unsigned_t<T>>(v);
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            buf.push_back(static_cast<char>(u & 0xff));
+            u = static_cast<decltype(u)>(u >> 8);
+        }
+    }
+
+    void put_bytes(const void *data, std::size_t n) {
+        put(static_cast<std::uint32_t>(n));
+        buf.append(static_cast<const char *>(data), n);
+    }
+
+    const std::string &bytes() const noexcept { return buf; }
+
+private:
+    std::string buf;
+};
+
+class Reader final {
+public:
+    explicit Reader(std::string_view b) : buf(b) {}
+
+    template <typename T>
+    bool get(T &v) noexcept {
+        static_assert(std::is_integral_v<T>);
+        if (buf.size() - off < sizeof(T)) {
+            return false;
+        }
+
+        std::make_unsigned_t<T> u{};
+        for (std::size_t i = sizeof(T); i-- > 0;) {
+            u = static_cast<decltype(u)>((u << 8) | static_cast<unsigned char>(buf[off + i]));
+        }
+
+        v = static_cast<T>(u);
+        off += sizeof(T);
+        return true;
+    }
+
+    bool get_bytes(std::string_view &out) noexcept {
+        std::uint32_t n{};
+        if (!get(n) || buf.size() - off < n) {
+            return false;
+        }
+
+        out = buf.substr(off, n);
+        off += n;
+        return true;
+    }
+
+    // Guards element counts against what the rest of the file could possibly hold
+    bool fits(std::uint32_t count, std::size_t elem_size) const noexcept {
+        return count <= (buf.size() - off) / elem_size;
+    }
+
+    bool at_end() const noexcept { return off == buf.size(); }
+
+private:
+    std::string_view buf;
+    std::size_t off{};
+};
+
+void put_rational(Writer &w, AVRational r) {
+    w.put(r.num);
+    w.put(r.den);
+}
+
+bool get_rational(Reader &r, AVRational &out) noexcept {
+    return r.get(out.num) && r.get(out.den);
+}
+
+void put_codecpar(Writer &w, const AVCodecParameters &p) {
+    w.put(static_cast<std::int32_t>(p.codec_type));
+    w.put(static_cast<std::int32_t>(p.codec_id));
+    w.put(p.codec_tag);
+    w.put(p.format);
+    w.put(p.bit_rate);
+    w.put(p.bits_per_coded_sample);
+    w.put(p.bits_per_raw_sample);
+    w.put(p.profile);
+    w.put(p.level);
+    w.put(p.width);
+    w.put(p.height);
+    put_rational(w, p.sample_aspect_ratio);
+    w.put(static_cast<std::int32_t>(p.field_order));
+    w.put(static_cast<std::int32_t>(p.color_range));
+    w.put(static_cast<std::int32_t>(p.color_primaries));
+    w.put(static_cast<std::int32_t>(p.color_trc));
+    w.put(static_cast<std::int32_t>(p.color_space));
+    w.put(static_cast<std::int32_t>(p.chroma_location));
+    w.put(p.video_delay);
+    w.put_bytes(p.extradata, p.extradata ? static_cast<std::size_t>(p.extradata_size) : 0);
+}
+
+bool get_codecpar(Reader &r, AVCodecParameters &p) {
+    std::array<std::int32_t, 8> e{};
+    std::string_view extradata;
+
+    const bool ok = r.get(e[0]) && r.get(e[1]) && r.get(p.codec_tag) && r.get(p.format) &&
+                    r.get(p.bit_rate) && r.get(p.bits_per_coded_sample) &&
+                    r.get(p.bits_per_raw_sample) && r.get(p.profile) && r.get(p.level) &&
+                    r.get(p.width) && r.get(p.height) && get_rational(r, p.sample_aspect_ratio) &&
+                    r.get(e[2]) && r.get(e[3]) && r.get(e[4]) && r.get(e[5]) && r.get(e[6]) &&
+                    r.get(e[7]) && r.get(p.video_delay) && r.get_bytes(extradata);
+    if (!ok) {
+        return false;
+    }
+
+    p.codec_type = static_cast<AVMediaType>(e[0]);
+    p.codec_id = static_cast<AVCodecID>(e[1]);
+    p.field_order = static_cast<AVFieldOrder>(e[2]);
+    p.color_range = static_cast<AVColorRange>(e[3]);
+    p.color_primaries = static_cast<AVColorPrimaries>(e[4]);
+    p.color_trc = static_cast<AVColorTransferCharacteristic>(e[5]);
+    p.color_space = static_cast<AVColorSpace>(e[6]);
+    p.chroma_location = static_cast<AVChromaLocation>(e[7]);
+
+    if (extradata.empty()) {
+        return true;
+    }
+
+    // Decoders may read past the end of extradata, FFmpeg requires the padding to be zeroed
+    const auto n = extradata.size();
+    p.extradata = static_cast<std::uint8_t *>(av_mallocz(n + AV_INPUT_BUFFER_PADDING_SIZE));
+    if (!p.extradata) {
+        return false;
+    }
+
+    std::memcpy(p.extradata, extradata.data(), n);
+    p.extradata_size = static_cast<int>(n);
+    return true;
+}
+}  // namespace
+
+std::string probe_sidecar_path(const std::string &path) {
+    return path + std::string{PROBE_CACHE_SUFFIX};
+}
+
+std::optional<ProbeKey> probe_key_of(const std::string &url) {
+    const auto local = local_path_of(url);
+    if (!local) {
+        return std::nullopt;
+    }
+
+    const fs::path path = *local;
+
+    std::error_code ec;
+    if (!fs::is_regular_file(path, ec)) {
+        return std::nullopt;
+    }
+
+    const auto size = fs::file_size(path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+
+    const auto mtime = fs::last_write_time(path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+
+    const auto mtime_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(mtime.time_since_epoch()).count();
+
+    return ProbeKey{path.string(), size, static_cast<std::int64_t>(mtime_ns)};
+}
+
+std::optional<ProbeInfo> load_probe_info(const ProbeKey &key) {
+    std::ifstream is(probe_sidecar_path(key.path), std::ios::binary);
+    if (!is) {
+        return std::nullopt;
+    }
+
+    const std::string buf{std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>()};
+    Reader r{buf};
+
+    std::array<char, PROBE_CACHE_MAGIC.size()> magic{};
+    std::uint32_t version{};
+    for (auto &c : magic) {
+        r.get(c);
+    }
+
+    if (magic != PROBE_CACHE_MAGIC || !r.get(version) || version != PROBE_CACHE_VERSION) {
+        return std::nullopt;
+    }
+
+    ProbeInfo info;
+    std::string_view path;
+    std::uint64_t size{};
+    if (!r.get_bytes(path) || !r.get(size) || !r.get(info.key.mtime)) {
+        return std::nullopt;
+    }
+
+    info.key.path = path;
+    info.key.size = size;
+    if (info.key != key) {
+        return std::nullopt;
+    }
+
+    info.codecpar.reset(avcodec_parameters_alloc());
+    if (!info.codecpar) {
+        return std::nullopt;
+    }
+
+    const bool ok = r.get(info.stream_index) && get_rational(r, info.time_base) &&
+                    get_rational(r, info.r_frame_rate) && get_rational(r, info.avg_frame_rate) &&
+                    r.get(info.start_time) && r.get(info.duration) &&
+                    get_codecpar(r, *info.codecpar);
+    if (!ok || info.stream_index < 0 || info.time_base.num <= 0 || info.time_base.den <= 0) {
+        return std::nullopt;
+    }
+
+    std::uint32_t n_keyframes{};
+    if (!r.get(n_keyframes) || !r.fits(n_keyframes, sizeof(KeyframeIndex::Entry))) {
+        return std::nullopt;
+    }
+
+    info.keyframes.resize(n_keyframes);
+    for (auto &kf : info.keyframes) {
+        if (!r.get(kf.pts) || !r.get(kf.dts) || !r.get(kf.pos)) {
+            return std::nullopt;
+        }
+    }
+
+    std::uint32_t n_spans{};
+    if (!r.get(n_spans) || !r.fits(n_spans, sizeof(KeyframeIndex::Span))) {
+        return std::nullopt;
+    }
+
+    info.spans.resize(n_spans);
+    for (auto &sp : info.spans) {
+        if (!r.get(sp.beg) || !r.get(sp.end) || sp.beg > sp.end) {
+            return std::nullopt;
+        }
+    }
+
+    if (!r.at_end()) {
+        return std::nullopt;
+    }
+
+    return info;
+}
+
+bool store_probe_info(const ProbeInfo &info) {
+    if (!info.codecpar) {
+        return false;
+    }
+
+    Writer w;
+    for (const auto c : PROBE_CACHE_MAGIC) {
+        w.put(c);
+    }
+
+    w.put(PROBE_CACHE_VERSION);
+    w.put_bytes(info.key.path.data(), info.key.path.size());
+    w.put(static_cast<std::uint64_t>(info.key.size));
+    w.put(info.key.mtime);
+
+    w.put(info.stream_index);
+    put_rational(w, info.time_base);
+    put_rational(w, info.r_frame_rate);
+    put_rational(w, info.avg_frame_rate);
+    w.put(info.start_time);
+    w.put(info.duration);
+    put_codecpar(w, *info.codecpar);
+
+    w.put(static_cast<std::uint32_t>(info.keyframes.size()));
+    for (const auto &kf : info.keyframes) {
+        w.put(kf.pts);
+        w.put(kf.dts);
+        w.put(kf.pos);
+    }
+
+    w.put(static_cast<std::uint32_t>(info.spans.size()));
+    for (const auto &sp : info.spans) {
+        w.put(sp.beg);
+        w.put(sp.end);
+    }
+
+    // Written next to the final name and renamed over it, so readers never see half a sidecar
+    const fs::path dst = probe_sidecar_path(info.key.path);
+    const auto uniq = std::hash<std::thread::id>{}(std::this_thread::get_id()) ^
+                      static_cast<std::size_t>(
+                          std::chrono::steady_clock::now().time_since_epoch().count());
+    fs::path tmp = dst;
+    tmp += ".tmp" + std::to_string(uniq);
+
+    {
+        std::ofstream os(tmp, std::ios::binary | std::ios::trunc);
+        if (!os) {
+            return false;
+        }
+
+        os.write(w.bytes().data(), static_cast<std::streamsize>(w.bytes().size()));
+        if (!os.flush()) {
+            os.close();
+            std::error_code ec;
+            fs::remove(tmp, ec);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tmp, dst, ec);
+    if (ec) {
+        fs::remove(tmp, ec);
+        return false;
+    }
+
+    return true;
+}
+}  // namespace splayer
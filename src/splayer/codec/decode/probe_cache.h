@@ -0,0 +1,83 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PROBE_CACHE_H_
+#define PROBE_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+#include "keyframe_index.h"
+
+namespace splayer {
+struct AvCodecParamsDeleter {
+    void operator()(AVCodecParameters *p) noexcept { avcodec_parameters_free(&p); }
+};
+
+using AVCodecParamsPtr = std::unique_ptr<AVCodecParameters, AvCodecParamsDeleter>;
+
+// Identifies one version of a local file. A sidecar only applies to the exact file it was written
+// for; any change in size or modification time makes it stale.
+struct ProbeKey {
+    std::string path;
+    std::uintmax_t size{};
+    std::int64_t mtime{};
+
+    bool operator==(const ProbeKey &) const = default;
+};
+
+// What `avformat_find_stream_info` worked out about the chosen video stream, plus the keyframes
+// seen while playing it.
+struct ProbeInfo {
+    ProbeKey key;
+    int stream_index{-1};
+    AVRational time_base{};
+    AVRational r_frame_rate{};
+    AVRational avg_frame_rate{};
+    std::int64_t start_time{};
+    std::int64_t duration{};
+    AVCodecParamsPtr codecpar;
+    std::vector<KeyframeIndex::Entry> keyframes;
+    std::vector<KeyframeIndex::Span> spans;
+};
+
+// Key of the local file behind `url` as it is right now, nothing for network inputs or files that
+// can't be stat'ed.
+std::optional<ProbeKey> probe_key_of(const std::string &url);
+
+// Reads the sidecar of `key.path`. Returns nothing when there is none, when it can't be parsed or
+// when it was written for a different version of the file.
+std::optional<ProbeInfo> load_probe_info(const ProbeKey &key);
+// Replaces the sidecar atomically, so a concurrent reader sees either the old or the new one.
+bool store_probe_info(const ProbeInfo &info);
+
+std::string probe_sidecar_path(const std::string &path);
+}  // namespace splayer
+
+#endif /* PROBE_CACHE_H_ */
@@ -29,54 +29,26 @@ extern "C" {
 #include <libswscale/swscale.h>
 }
 
+#include <splayer/util/profiler.h>
 #include <splayer/util/utils.h>
 
 using namespace utils;
 
 namespace splayer {
-SwDecoder::SwDecoder() {
+SwDecoder::SwDecoder() : Decoder(SWS_BILINEAR) {
     frame.reset(av_frame_alloc());
-    frame_cnvt.reset(av_frame_alloc());
+    pkt.reset(av_packet_alloc());
 
-    if (!frame || !frame_cnvt) {
+    if (!frame) {
         throw std::runtime_error("Failed to allocate av_frame.");
     }
-}
-
-// TODO: In the event that failure happens further down, and we return, we fail to free/close a
-// bunch of contexts that were made
-void SwDecoder::open_input(const std::string &url) {
-    int ret{};
-
-    // Note: avformat_open_input will allocate our context for us.
-    ret = avformat_open_input(&format_ctx_, url.c_str(), nullptr, nullptr);
-    if (ret < 0) {
-        Log(Log::ERROR) << "Failed to open input stream and/or read the header of: " << url;
-        throw DecoderError(DecoderErrorDesc::FAILURE, ret);
-    }
 
-    ret = avformat_find_stream_info(format_ctx_, nullptr);
-    if (ret < 0) {
-        Log(Log::ERROR) << "Failed to read stream information.";
-        throw DecoderError(DecoderErrorDesc::FAILURE, ret);
+    if (!pkt) {
+        throw std::runtime_error("Failed to allocate av_packet.");
     }
-
-    find_best_stream();
 }
 
-void SwDecoder::find_best_stream() {
-    int ret{};
-
-    ret = av_find_best_stream(format_ctx_, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
-    if (ret < 0) {
-        Log(Log::ERROR) << "Failed to find valid stream/decoder.";
-        throw DecoderError(DecoderErrorDesc::FAILURE, ret);
-    }
-
-    best_vid_stream_id_ = ret;
-
-    find_decoder();
-}
+void SwDecoder::setup_codec() { find_decoder(); }
 
 void SwDecoder::find_decoder() {
     const auto decoder_id = get_decoder_id();
@@ -134,16 +106,7 @@ void SwDecoder::setup_decoder() {
 void SwDecoder::open_codec() {
     int ret{};
 
-    // set codec to automatically determine how many threads suits best for the decoding job
-    codec_ctx_->thread_count = 0;
-
-    if (codec_->capabilities | AV_CODEC_CAP_FRAME_THREADS) {
-        codec_ctx_->thread_type = FF_THREAD_FRAME;
-    } else if (codec_->capabilities | AV_CODEC_CAP_SLICE_THREADS) {
-        codec_ctx_->thread_type = FF_THREAD_SLICE;
-    } else {
-        codec_ctx_->thread_count = 1;  // don't use multithreading
-    }
+    apply_threading(codec_ctx_, codec_);
 
     ret = avcodec_open2(codec_ctx_, codec_, nullptr);
     if (ret < 0) {
@@ -152,83 +115,65 @@ void SwDecoder::open_codec() {
     }
 }
 
-bool SwDecoder::packet_is_from_video_stream(const AVPacket *p) const noexcept {
-    return (p->stream_index == best_vid_stream_id_);
-}
+void SwDecoder::send_packet(const AVPacket *p) {
+    int ret;
+    {
+        PROF_ZONE(SEND_PACKET);
+        ret = avcodec_send_packet(codec_ctx_, p);
+    }
 
-void SwDecoder::setup_cnvt_process() noexcept {
-    if (buf_size) {
-        return;
+    if (ret < 0 && ret != AVERROR_EOF) {
+        Log(Log::ERROR) << "Error sending packet for decoding.";
+        throw DecoderError{DecoderErrorDesc::FAILURE, ret};
     }
+}
 
-    constexpr auto PIX_FMT = AV_PIX_FMT_RGB24;
+bool SwDecoder::receive_frame(AVFrame *out) {
+    while (true) {
+        int ret;
+        {
+            PROF_ZONE(RECEIVE_FRAME);
+            ret = avcodec_receive_frame(codec_ctx_, out);
+        }
 
-    buf_size = av_image_get_buffer_size(
-        PIX_FMT, codec_ctx_->width, codec_ctx_->height, FRAME_BUF_ALIGNMENT);
-    cnvt_buf = static_cast<std::uint8_t *>(av_malloc(buf_size * sizeof(std::uint8_t)));
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+            return false;
+        } else if (ret < 0) {
+            Log(Log::ERROR) << "Error while decoding.";
+            throw DecoderError{DecoderErrorDesc::FAILURE, ret};
+        }
 
-    av_image_fill_arrays(frame_cnvt->data, frame_cnvt->linesize, cnvt_buf, PIX_FMT,
-        codec_ctx_->width, codec_ctx_->height, FRAME_BUF_ALIGNMENT);
+        if (!before_seek_target(out)) {
+            return true;
+        }
 
-    sws_ctx = sws_getContext(codec_ctx_->width, codec_ctx_->height, codec_ctx_->pix_fmt,
-        codec_ctx_->width, codec_ctx_->height, PIX_FMT, SWS_BILINEAR, nullptr, nullptr,
-        nullptr);
+        av_frame_unref(out);
+    }
 }
 
-AVFrame *SwDecoder::decode_frame() {
-    AVPacket pkt{};
-    int ret{};
+PooledFramePtr SwDecoder::decode_frame() {
+    while (!receive_frame(frame.get())) {
+        if (!read_packet(pkt.get())) {
+            return {};
+        }
 
-    if (buf_size == 0) {
-        setup_cnvt_process();
+        send_packet(pkt.get());
+        av_packet_unref(pkt.get());
     }
 
-    while (av_read_frame(format_ctx_, &pkt) >= 0) {
-        if (pkt.stream_index == best_vid_stream_id_) {
-            ret = avcodec_send_packet(codec_ctx_, &pkt);
-            if (ret < 0) {
-                Log(Log::ERROR) << "Error sending packet for decoding.";
-                throw DecoderError{DecoderErrorDesc::FAILURE, ret};
-            }
-
-            bool frm_success = (ret >= 0);
-
-            while (frm_success) {
-                ret = avcodec_receive_frame(codec_ctx_, frame.get());
-
-                if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-                    break;
-                } else if (ret < 0) {
-                    Log(Log::ERROR) << "Error while decoding.";
-                    throw DecoderError{DecoderErrorDesc::FAILURE, ret};
-                }
-
-                sws_scale(sws_ctx, static_cast<uint8_t const *const *>(frame->data),
-                    frame->linesize, 0, codec_ctx_->height, frame_cnvt->data, frame_cnvt->linesize);
-
-                frame_cnvt->width = codec_ctx_->width;
-                frame_cnvt->height = codec_ctx_->height;
-
-                return frame_cnvt.get();
-            }
-
-            if (frm_success) {
-                break;
-            }
-        }
+    auto f = convert_frame(frame.get());
+    if (!f) {
+        Log(Log::ERROR) << "Every pooled frame is still held by a consumer.";
+        throw DecoderError(DecoderErrorDesc::FAILURE);
     }
 
-    return nullptr;
+    return f;
 }
 
-double SwDecoder::clip_fps() const noexcept {
-    return av_q2d(format_ctx_->streams[best_vid_stream_id_]->r_frame_rate);
-}
+std::string SwDecoder::name() const { return "sw"; }
 
 SwDecoder::~SwDecoder() {
-    av_free(cnvt_buf);
     avcodec_free_context(&codec_ctx_);
-
-    cnvt_buf = nullptr;
+    avcodec_free_context(&codec_ctx_orig_);
 }
 }  // namespace splayer
\ No newline at end of file
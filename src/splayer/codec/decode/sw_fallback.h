@@ -20,9 +20,13 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#ifndef SW_FALLBACK_H_
+#define SW_FALLBACK_H_
+
+#include <string>
+
 #include "decoder.h"
 
-struct AVFormatContext;
 struct AVCodecContext;
 struct AVCodec;
 struct AVPacket;
@@ -34,35 +38,28 @@ public:
     SwDecoder();
     virtual ~SwDecoder() override;
 
-    void open_input(const std::string &url) override;
+    void send_packet(const AVPacket *pkt) override;
+    bool receive_frame(AVFrame *out) override;
+    PooledFramePtr decode_frame() override;
+
+    std::string name() const override;
 
-    AVFrame *decode_frame();
-    double clip_fps() const noexcept;
+protected:
+    void setup_codec() override;
+    AVCodecContext *codec_context() noexcept override { return codec_ctx_; }
 
 private:
-    void find_best_stream();
     void find_decoder();
     int get_decoder_id() noexcept;
     void setup_decoder();
     void open_codec();
 
-    bool packet_is_from_video_stream(const AVPacket *p) const noexcept;
-
-    void setup_cnvt_process() noexcept;
-
-    AVFormatContext *format_ctx_{nullptr};
     const AVCodec *codec_{nullptr};
     AVCodecContext *codec_ctx_orig_{nullptr}, *codec_ctx_{nullptr};
 
-    AVFramePtr frame, frame_cnvt;
-
-    SwsContext *sws_ctx{nullptr};
-
-    int best_vid_stream_id_{-1};
-    int buf_size{};
-
-    std::uint8_t *cnvt_buf{nullptr};
-
-    static constexpr auto FRAME_BUF_ALIGNMENT = 32;
+    AVFramePtr frame;
+    AVPacketPtr pkt;
 };
-}  // namespace splayer
\ No newline at end of file
+}  // namespace splayer
+
+#endif /* SW_FALLBACK_H_ */
@@ -0,0 +1,79 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "input_io.h"
+
+extern "C" {
+#include <libavformat/avio.h>
+#include <libavutil/mem.h>
+}
+
+#include "mmap_io.h"
+#include "readahead_io.h"
+
+namespace splayer {
+void AvioContextDeleter::operator()(AVIOContext *ctx) const noexcept {
+    av_freep(&ctx->buffer);
+    avio_context_free(&ctx);
+}
+
+std::unique_ptr<InputIo> make_input_io(
+    InputIoMode mode, const std::string &path, const InputIoConfig &cfg) {
+    switch (mode) {
+        case InputIoMode::MMAP:
+            return std::make_unique<MmapIo>(path);
+        case InputIoMode::READAHEAD:
+            return std::make_unique<ReadaheadIo>(path, cfg);
+        case InputIoMode::DEFAULT:
+            break;
+    }
+
+    return nullptr;
+}
+
+std::optional<std::string> local_path_of(const std::string &url) {
+    const auto proto = url.find("://");
+    if (proto == std::string::npos) {
+        // Also covers the "file:path" form without slashes
+        return (url.starts_with("file:") ? url.substr(5) : url);
+    }
+
+    if (url.compare(0, proto, "file") != 0) {
+        return std::nullopt;
+    }
+
+    return url.substr(proto + 3);
+}
+
+const char *input_io_name(InputIoMode mode) noexcept {
+    switch (mode) {
+        case InputIoMode::DEFAULT:
+            return "default";
+        case InputIoMode::MMAP:
+            return "mmap";
+        case InputIoMode::READAHEAD:
+            return "readahead";
+    }
+
+    return "?";
+}
+}  // namespace splayer
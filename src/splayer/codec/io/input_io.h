@@ -0,0 +1,85 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef INPUT_IO_H_
+#define INPUT_IO_H_
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct AVIOContext;
+
+namespace splayer {
+enum class InputIoMode {
+    // Whatever protocol libavformat picks for the url
+    DEFAULT,
+    // Local files are read straight out of a shared mapping, see `MmapIo`
+    MMAP,
+    // Local files are prefetched into a ring of blocks ahead of the demuxer, see `ReadaheadIo`
+    READAHEAD
+};
+
+struct InputIoConfig {
+    // Readahead ring, the window kept in flight ahead of the demuxer is their product
+    std::size_t readahead_blocks{32};
+    std::size_t readahead_block_bytes{1024 * 1024};
+    // Workers of the pread fallback when io_uring is unavailable
+    std::size_t readahead_threads{4};
+    bool readahead_uring{true};
+};
+
+// Frees the context together with its buffer, which libavformat may have reallocated.
+struct AvioContextDeleter {
+    void operator()(AVIOContext *ctx) const noexcept;
+};
+
+using AVIOContextPtr = std::unique_ptr<AVIOContext, AvioContextDeleter>;
+
+// Named counters an `InputIo` collected, in the same shape as the bench report metrics.
+using InputIoStats = std::vector<std::pair<std::string, double>>;
+
+// Replacement for libavformat's own IO on local files. The context stays owned by the `InputIo`,
+// which has to outlive the `AVFormatContext` reading from it.
+class InputIo {
+public:
+    virtual AVIOContext *avio() noexcept = 0;
+    // Only valid while nothing is reading from the context.
+    virtual InputIoStats stats() const { return {}; }
+    virtual ~InputIo() = default;
+};
+
+// Returns an empty pointer when `mode` leaves the input to libavformat. Throws if the file can't
+// be opened with the requested mode.
+std::unique_ptr<InputIo> make_input_io(
+    InputIoMode mode, const std::string &path, const InputIoConfig &cfg = {});
+
+// Filesystem path behind `url` when it names a local file, i.e. has no protocol or "file:".
+std::optional<std::string> local_path_of(const std::string &url);
+
+const char *input_io_name(InputIoMode mode) noexcept;
+}  // namespace splayer
+
+#endif /* INPUT_IO_H_ */
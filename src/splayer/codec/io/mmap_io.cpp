@@ -0,0 +1,181 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mmap_io.h"
+
+extern "C" {
+#include <libavformat/avio.h>
+#include <libavutil/error.h>
+#include <libavutil/mem.h>
+}
+
+#ifdef LIN
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <splayer/util/utils.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace utils;
+
+namespace splayer {
+#ifdef LIN
+MmapIo::MmapIo(const std::string &path) {
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open " + path + " for mapping.");
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        throw std::runtime_error("Can't map " + path + ", not a regular non-empty file.");
+    }
+
+    map_size = static_cast<std::size_t>(st.st_size);
+    void *m = mmap(nullptr, map_size, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping keeps the file referenced on its own
+    close(fd);
+
+    if (m == MAP_FAILED) {
+        throw std::runtime_error("Failed to map " + path);
+    }
+
+    map = static_cast<const std::uint8_t *>(m);
+    page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    madvise(m, map_size, MADV_SEQUENTIAL);
+    advise(0);
+
+    auto *buf = static_cast<unsigned char *>(av_malloc(IO_BUF_SIZE));
+    if (buf) {
+        ctx.reset(avio_alloc_context(buf, IO_BUF_SIZE, 0, this, &MmapIo::read_cb, nullptr,
+            &MmapIo::seek_cb));
+    }
+
+    if (!ctx) {
+        av_free(buf);
+        munmap(m, map_size);
+        throw std::runtime_error("Failed to allocate AVIOContext.");
+    }
+
+    // Large reads skip the context buffer and land in the caller's (usually packet) memory.
+    ctx->direct = 1;
+}
+
+MmapIo::~MmapIo() {
+    if (map) {
+        munmap(const_cast<std::uint8_t *>(map), map_size);
+    }
+}
+
+int MmapIo::read_cb(void *opaque, std::uint8_t *buf, int size) {
+    auto *self = static_cast<MmapIo *>(opaque);
+    const auto n = std::min(static_cast<std::size_t>(size), self->map_size - self->pos);
+    if (n == 0) {
+        return AVERROR_EOF;
+    }
+
+    std::memcpy(buf, self->map + self->pos, n);
+    self->advise(self->pos + n);
+
+    return static_cast<int>(n);
+}
+
+std::int64_t MmapIo::seek_cb(void *opaque, std::int64_t offset, int whence) {
+    auto *self = static_cast<MmapIo *>(opaque);
+    const auto size = static_cast<std::int64_t>(self->map_size);
+
+    if (whence & AVSEEK_SIZE) {
+        return size;
+    }
+
+    std::int64_t target{};
+    switch (whence & ~AVSEEK_FORCE) {
+        case SEEK_SET:
+            target = offset;
+            break;
+        case SEEK_CUR:
+            target = static_cast<std::int64_t>(self->pos) + offset;
+            break;
+        case SEEK_END:
+            target = size + offset;
+            break;
+        default:
+            return AVERROR(EINVAL);
+    }
+
+    if (target < 0 || target > size) {
+        return AVERROR(EINVAL);
+    }
+
+    self->advise(static_cast<std::size_t>(target));
+    return target;
+}
+
+void MmapIo::advise(std::size_t new_pos) noexcept {
+    pos = new_pos;
+
+    // Only re-advise once demuxing is halfway through the window, or jumped out of it
+    if (pos >= advised_beg && pos + READAHEAD_BYTES / 2 < advised_end) {
+        return;
+    }
+
+    auto *base = const_cast<std::uint8_t *>(map);
+    const auto beg = pos & ~(page_size - 1);
+    const auto end = std::min(map_size, beg + READAHEAD_BYTES);
+
+    madvise(base + beg, end - beg, MADV_WILLNEED);
+
+    // Pages a whole window behind the current position are unlikely to be read again soon, giving
+    // them back keeps the resident set flat on long files. They're still in the page cache.
+    if (beg > READAHEAD_BYTES && advised_beg < beg - READAHEAD_BYTES) {
+        const auto drop_end = beg - READAHEAD_BYTES;
+        madvise(base + advised_beg, drop_end - advised_beg, MADV_DONTNEED);
+    }
+
+    advised_beg = beg;
+    advised_end = end;
+}
+#else
+MmapIo::MmapIo(const std::string &) {
+    throw std::runtime_error("Memory mapped input is not supported on this platform.");
+}
+
+MmapIo::~MmapIo() = default;
+
+int MmapIo::read_cb(void *, std::uint8_t *, int) {
+    return AVERROR(ENOSYS);
+}
+
+std::int64_t MmapIo::seek_cb(void *, std::int64_t, int) {
+    return AVERROR(ENOSYS);
+}
+
+void MmapIo::advise(std::size_t) noexcept {}
+#endif
+}  // namespace splayer
@@ -0,0 +1,72 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef MMAP_IO_H_
+#define MMAP_IO_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "input_io.h"
+
+namespace splayer {
+// Serves a local file from a read-only mapping instead of `read()` calls. The AVIOContext runs in
+// direct mode, so packet payloads are copied from the mapped page cache straight into the packet
+// without going through the context's buffer. The kernel is told to read ahead of wherever
+// demuxing currently is and to drop the pages left far behind it.
+//
+// Truncating the file while it is mapped makes reads past the new end fault, same as any other
+// mmap reader.
+class MmapIo final : public InputIo {
+public:
+    explicit MmapIo(const std::string &path);
+    MmapIo(const MmapIo &) = delete;
+    MmapIo &operator=(const MmapIo &) = delete;
+    ~MmapIo() override;
+
+    AVIOContext *avio() noexcept override { return ctx.get(); }
+
+private:
+    static int read_cb(void *opaque, std::uint8_t *buf, int size);
+    static std::int64_t seek_cb(void *opaque, std::int64_t offset, int whence);
+
+    // Keeps a window ahead of `pos` advised and releases what's far enough behind it.
+    void advise(std::size_t new_pos) noexcept;
+
+    // Size of the AVIOContext buffer, only used for the demuxer's small header reads
+    static constexpr int IO_BUF_SIZE = 64 * 1024;
+    static constexpr std::size_t READAHEAD_BYTES = 8 * 1024 * 1024;
+
+    const std::uint8_t *map{nullptr};
+    std::size_t map_size{};
+    std::size_t page_size{};
+    std::size_t pos{};
+    // Advised range [advised_beg, advised_end)
+    std::size_t advised_beg{};
+    std::size_t advised_end{};
+
+    AVIOContextPtr ctx;
+};
+}  // namespace splayer
+
+#endif /* MMAP_IO_H_ */
@@ -0,0 +1,605 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "readahead_io.h"
+
+extern "C" {
+#include <libavformat/avio.h>
+#include <libavutil/error.h>
+#include <libavutil/mem.h>
+}
+
+#ifdef LIN
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define SPLAYER_HAVE_IO_URING
+#endif
+#endif
+
+#include <splayer/util/utils.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+using namespace utils;
+
+namespace splayer {
+// Asynchronous positional reads into caller owned memory. Submitting and reaping both happen on
+// the demux thread.
+class ReadEngine {
+public:
+    virtual void submit(std::size_t tag, std::uint8_t *buf, std::size_t len, std::int64_t off) = 0;
+    // Appends finished reads to `out`, blocking until there is at least one if `wait`.
+    virtual void reap(bool wait, std::vector<ReadCompletion> &out) = 0;
+    virtual ~ReadEngine() = default;
+};
+
+#ifdef LIN
+namespace {
+class PreadEngine final : public ReadEngine {
+public:
+    PreadEngine(int file, std::size_t threads) : fd(file) {
+        for (std::size_t i = 0; i < std::max<std::size_t>(threads, 1); ++i) {
+            workers.emplace_back([this] { work(); });
+        }
+    }
+
+    ~PreadEngine() override {
+        {
+            std::lock_guard lock(mtx);
+            stopping = true;
+        }
+
+        work_cv.notify_all();
+        for (auto &w : workers) {
+            w.join();
+        }
+    }
+
+    void submit(std::size_t tag, std::uint8_t *buf, std::size_t len, std::int64_t off) override {
+        {
+            std::lock_guard lock(mtx);
+            requests.push_back({tag, buf, len, off});
+        }
+
+        work_cv.notify_one();
+    }
+
+    void reap(bool wait, std::vector<ReadCompletion> &out) override {
+        std::unique_lock lock(mtx);
+        if (wait) {
+            done_cv.wait(lock, [this] { return !done.empty(); });
+        }
+
+        out.insert(out.end(), done.begin(), done.end());
+        done.clear();
+    }
+
+private:
+    struct Request {
+        std::size_t tag;
+        std::uint8_t *buf;
+        std::size_t len;
+        std::int64_t off;
+    };
+
+    void work() {
+        while (true) {
+            Request r;
+            {
+                std::unique_lock lock(mtx);
+                work_cv.wait(lock, [this] { return stopping || !requests.empty(); });
+                if (requests.empty()) {
+                    return;
+                }
+
+                r = requests.front();
+                requests.pop_front();
+            }
+
+            ssize_t res;
+            do {
+                res = pread(fd, r.buf, r.len, r.off);
+            } while (res < 0 && errno == EINTR);
+
+            {
+                std::lock_guard lock(mtx);
+                done.push_back({r.tag, res < 0 ? -errno : res});
+            }
+
+            done_cv.notify_one();
+        }
+    }
+
+    int fd;
+    std::mutex mtx;
+    std::condition_variable work_cv, done_cv;
+    std::deque<Request> requests;
+    std::vector<ReadCompletion> done;
+    bool stopping{false};
+    std::vector<std::thread> workers;
+};
+
+#ifdef SPLAYER_HAVE_IO_URING
+// Talks to the kernel through the raw syscalls and the shared rings, which is all liburing does for
+// plain reads.
+class UringEngine final : public ReadEngine {
+public:
+    UringEngine(int file, unsigned entries) : fd(file) {
+        io_uring_params p{};
+        ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &p));
+        if (ring_fd < 0) {
+            throw std::runtime_error("io_uring_setup failed.");
+        }
+
+        // Everything mapped so far goes again if any later step fails
+        try {
+            init(p);
+        } catch (...) {
+            release();
+            throw;
+        }
+    }
+
+    ~UringEngine() override { release(); }
+
+    void submit(std::size_t tag, std::uint8_t *buf, std::size_t len, std::int64_t off) override {
+        const unsigned tail = *sq_tail;
+        // The owner never has more reads in flight than the ring was sized for
+        ASSERT(tail - std::atomic_ref(*sq_head).load(std::memory_order_acquire) < sq_entries);
+
+        const unsigned idx = tail & sq_mask;
+        auto &sqe = sqes[idx];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<std::uint64_t>(buf);
+        sqe.len = static_cast<std::uint32_t>(len);
+        sqe.off = static_cast<std::uint64_t>(off);
+        sqe.user_data = tag;
+        sq_array[idx] = idx;
+
+        std::atomic_ref(*sq_tail).store(tail + 1, std::memory_order_release);
+        enter(1, 0, 0);
+    }
+
+    void reap(bool wait, std::vector<ReadCompletion> &out) override {
+        while (true) {
+            const unsigned head = *cq_head;
+            const unsigned tail = std::atomic_ref(*cq_tail).load(std::memory_order_acquire);
+
+            if (head != tail) {
+                for (unsigned i = head; i != tail; ++i) {
+                    const auto &cqe = cqes[i & cq_mask];
+                    out.push_back({static_cast<std::size_t>(cqe.user_data), cqe.res});
+                }
+
+                std::atomic_ref(*cq_head).store(tail, std::memory_order_release);
+                return;
+            }
+
+            if (!wait) {
+                return;
+            }
+
+            enter(0, 1, IORING_ENTER_GETEVENTS);
+        }
+    }
+
+private:
+    void init(const io_uring_params &p) {
+        sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_len = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        const bool single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP);
+        if (single_mmap) {
+            sq_len = cq_len = std::max(sq_len, cq_len);
+        }
+
+        sq_ring = map_ring(sq_len, IORING_OFF_SQ_RING);
+        cq_ring = (single_mmap ? sq_ring : map_ring(cq_len, IORING_OFF_CQ_RING));
+        sqes_len = p.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe *>(map_ring(sqes_len, IORING_OFF_SQES));
+
+        auto *sq = static_cast<std::uint8_t *>(sq_ring);
+        auto *cq = static_cast<std::uint8_t *>(cq_ring);
+        sq_head = reinterpret_cast<unsigned *>(sq + p.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned *>(sq + p.sq_off.tail);
+        sq_mask = *reinterpret_cast<unsigned *>(sq + p.sq_off.ring_mask);
+        sq_entries = p.sq_entries;
+        sq_array = reinterpret_cast<unsigned *>(sq + p.sq_off.array);
+        cq_head = reinterpret_cast<unsigned *>(cq + p.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned *>(cq + p.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned *>(cq + p.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe *>(cq + p.cq_off.cqes);
+
+        // IORING_OP_READ needs 5.6, older kernels only fail it once it's submitted
+        std::uint8_t probe{};
+        std::vector<ReadCompletion> c;
+        submit(0, &probe, 1, 0);
+        reap(true, c);
+        if (c.front().res == -EINVAL || c.front().res == -EOPNOTSUPP) {
+            throw std::runtime_error("io_uring does not support IORING_OP_READ.");
+        }
+    }
+
+    void *map_ring(std::size_t len, off_t offset) {
+        void *p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+            offset);
+        if (p == MAP_FAILED) {
+            throw std::runtime_error("Failed to map io_uring rings.");
+        }
+
+        return p;
+    }
+
+    void enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+        while (syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0) <
+               0) {
+            if (errno != EINTR) {
+                Log(Log::ERROR) << "io_uring_enter failed: " << std::strerror(errno);
+                throw std::runtime_error("io_uring_enter failed.");
+            }
+        }
+    }
+
+    void release() noexcept {
+        if (sqes) {
+            munmap(sqes, sqes_len);
+        }
+
+        if (cq_ring && cq_ring != sq_ring) {
+            munmap(cq_ring, cq_len);
+        }
+
+        if (sq_ring) {
+            munmap(sq_ring, sq_len);
+        }
+
+        if (ring_fd >= 0) {
+            close(ring_fd);
+        }
+
+        sqes = nullptr;
+        sq_ring = cq_ring = nullptr;
+        ring_fd = -1;
+    }
+
+    int fd;
+    int ring_fd{-1};
+
+    void *sq_ring{nullptr};
+    void *cq_ring{nullptr};
+    io_uring_sqe *sqes{nullptr};
+    std::size_t sq_len{}, cq_len{}, sqes_len{};
+
+    unsigned *sq_head{}, *sq_tail{}, *sq_array{};
+    unsigned sq_mask{}, sq_entries{};
+    unsigned *cq_head{}, *cq_tail{};
+    unsigned cq_mask{};
+    io_uring_cqe *cqes{};
+};
+#endif
+}  // namespace
+
+ReadaheadIo::ReadaheadIo(const std::string &path, const InputIoConfig &cfg)
+    : fd(open(path.c_str(), O_RDONLY | O_CLOEXEC)),
+      block_bytes(std::max<std::size_t>(cfg.readahead_block_bytes, 64 * 1024)) {
+    if (!fd) {
+        throw std::runtime_error("Failed to open " + path + " for readahead.");
+    }
+
+    struct stat st;
+    if (fstat(fd.get(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        throw std::runtime_error("Can't read ahead in " + path + ", not a regular file.");
+    }
+
+    file_size = st.st_size;
+    // The kernel's own readahead would only duplicate ours
+    posix_fadvise(fd.get(), 0, 0, POSIX_FADV_RANDOM);
+
+    blocks.resize(std::max<std::size_t>(cfg.readahead_blocks, 2));
+    for (auto &b : blocks) {
+        b.data = std::make_unique<std::uint8_t[]>(block_bytes);
+    }
+
+#ifdef SPLAYER_HAVE_IO_URING
+    if (cfg.readahead_uring) {
+        try {
+            engine =
+                std::make_unique<UringEngine>(fd.get(), static_cast<unsigned>(blocks.size()));
+            uring = true;
+        } catch (const std::exception &e) {
+            SPLAYER_LOG(INFO) << e.what() << " Reading ahead with pread threads instead.";
+        }
+    }
+#endif
+
+    if (!engine) {
+        engine = std::make_unique<PreadEngine>(fd.get(), cfg.readahead_threads);
+    }
+
+    SPLAYER_LOG(INFO) << "Reading ahead " << blocks.size() << " x " << block_bytes / 1024
+                      << " KiB blocks through " << (uring ? "io_uring" : "pread threads");
+
+    auto *buf = static_cast<unsigned char *>(av_malloc(IO_BUF_SIZE));
+    if (buf) {
+        ctx.reset(avio_alloc_context(buf, IO_BUF_SIZE, 0, this, &ReadaheadIo::read_cb, nullptr,
+            &ReadaheadIo::seek_cb));
+    }
+
+    if (!ctx) {
+        av_free(buf);
+        throw std::runtime_error("Failed to allocate AVIOContext.");
+    }
+
+    // Large reads skip the context buffer and are copied from the block straight to the packet
+    ctx->direct = 1;
+
+    try {
+        restart(0);
+    } catch (...) {
+        // The members are freed without running the destructor, which waits for these reads
+        try {
+            drain();
+        } catch (const std::exception &e) {
+            Log(Log::ERROR) << "Failed to wait for readahead: " << e.what();
+        }
+
+        throw;
+    }
+}
+
+ReadaheadIo::~ReadaheadIo() {
+    // Nothing may still be reading into the blocks once they're freed
+    try {
+        drain();
+    } catch (const std::exception &e) {
+        Log(Log::ERROR) << "Failed to wait for readahead: " << e.what();
+    }
+}
+
+int ReadaheadIo::read_cb(void *opaque, std::uint8_t *buf, int size) {
+    try {
+        return static_cast<ReadaheadIo *>(opaque)->read(buf, size);
+    } catch (const std::exception &) {
+        return AVERROR(EIO);
+    }
+}
+
+std::int64_t ReadaheadIo::seek_cb(void *opaque, std::int64_t offset, int whence) {
+    auto *self = static_cast<ReadaheadIo *>(opaque);
+
+    if (whence & AVSEEK_SIZE) {
+        return self->file_size;
+    }
+
+    std::int64_t target{};
+    switch (whence & ~AVSEEK_FORCE) {
+        case SEEK_SET:
+            target = offset;
+            break;
+        case SEEK_CUR:
+            target = self->pos + offset;
+            break;
+        case SEEK_END:
+            target = self->file_size + offset;
+            break;
+        default:
+            return AVERROR(EINVAL);
+    }
+
+    if (target < 0 || target > self->file_size) {
+        return AVERROR(EINVAL);
+    }
+
+    // The window follows lazily on the next read, the demuxer often seeks back and forth in place
+    self->pos = target;
+    return target;
+}
+
+int ReadaheadIo::read(std::uint8_t *buf, int size) {
+    if (pos >= file_size) {
+        return AVERROR_EOF;
+    }
+
+    const auto window_bytes = static_cast<std::int64_t>(blocks.size() * block_bytes);
+    if (pos < window_beg || pos >= window_beg + window_bytes) {
+        restart(pos);
+    }
+
+    // Picks up whatever landed meanwhile, keeps the in flight accounting honest
+    reap(false);
+    advance();
+
+    auto &b = blocks[head];
+    if (b.in_flight) {
+        const auto beg = std::chrono::steady_clock::now();
+        wait_for(head);
+        stalls += 1;
+        stall_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - beg)
+                        .count();
+    }
+
+    reads += 1;
+    in_flight_bytes_sum += static_cast<double>(in_flight_bytes);
+
+    if (b.error < 0) {
+        return AVERROR(-b.error);
+    }
+
+    const auto at = static_cast<std::size_t>(pos - b.off);
+    if (at >= b.filled) {
+        // The file shrank under us
+        return AVERROR_EOF;
+    }
+
+    const auto n = std::min(static_cast<std::size_t>(size), b.filled - at);
+    std::memcpy(buf, b.data.get() + at, n);
+    pos += static_cast<std::int64_t>(n);
+
+    return static_cast<int>(n);
+}
+
+void ReadaheadIo::restart(std::int64_t at) {
+    drain();
+
+    const auto bb = static_cast<std::int64_t>(block_bytes);
+    window_beg = at - at % bb;
+    head = 0;
+    restarts += 1;
+
+    for (std::size_t i = 0; i < blocks.size(); ++i) {
+        blocks[i].off = window_beg + static_cast<std::int64_t>(i) * bb;
+        submit(i);
+    }
+}
+
+void ReadaheadIo::advance() {
+    const auto bb = static_cast<std::int64_t>(block_bytes);
+    const auto window_bytes = static_cast<std::int64_t>(blocks.size()) * bb;
+
+    while (pos >= window_beg + bb) {
+        // A block skipped without being read still has to land before its memory is reused
+        wait_for(head);
+
+        blocks[head].off = window_beg + window_bytes;
+        submit(head);
+
+        head = (head + 1) % blocks.size();
+        window_beg += bb;
+    }
+}
+
+void ReadaheadIo::submit(std::size_t idx) {
+    auto &b = blocks[idx];
+    b.filled = 0;
+    b.error = 0;
+    b.want = static_cast<std::size_t>(
+        std::clamp<std::int64_t>(file_size - b.off, 0, static_cast<std::int64_t>(block_bytes)));
+
+    if (b.want == 0) {
+        b.in_flight = false;
+        return;
+    }
+
+    b.in_flight = true;
+    in_flight_blocks += 1;
+    in_flight_bytes += b.want;
+    peak_in_flight_bytes = std::max(peak_in_flight_bytes, in_flight_bytes);
+
+    engine->submit(idx, b.data.get(), b.want, b.off);
+}
+
+void ReadaheadIo::complete(std::size_t idx, std::int64_t res) {
+    auto &b = blocks[idx];
+
+    if (res > 0) {
+        b.filled += static_cast<std::size_t>(res);
+        if (b.filled < b.want) {
+            // Short read, ask for the rest
+            engine->submit(idx, b.data.get() + b.filled, b.want - b.filled,
+                b.off + static_cast<std::int64_t>(b.filled));
+            return;
+        }
+    } else if (res == -EINTR || res == -EAGAIN) {
+        engine->submit(idx, b.data.get() + b.filled, b.want - b.filled,
+            b.off + static_cast<std::int64_t>(b.filled));
+        return;
+    } else if (res < 0) {
+        b.error = static_cast<int>(res);
+    }
+
+    b.in_flight = false;
+    in_flight_blocks -= 1;
+    in_flight_bytes -= b.want;
+}
+
+void ReadaheadIo::reap(bool wait) {
+    reaped.clear();
+    engine->reap(wait, reaped);
+    for (const auto &c : reaped) {
+        complete(c.tag, c.res);
+    }
+}
+
+void ReadaheadIo::wait_for(std::size_t idx) {
+    while (blocks[idx].in_flight) {
+        reap(true);
+    }
+}
+
+void ReadaheadIo::drain() {
+    while (in_flight_blocks > 0) {
+        reap(true);
+    }
+}
+
+InputIoStats ReadaheadIo::stats() const {
+    const auto kib = [](double bytes) { return bytes / 1024.0; };
+    const auto mean_in_flight = (reads ? in_flight_bytes_sum / static_cast<double>(reads) : 0.0);
+
+    return {
+        {"readahead window KiB", kib(static_cast<double>(blocks.size() * block_bytes))},
+        {"readahead io_uring", uring ? 1.0 : 0.0},
+        {"readahead reads", static_cast<double>(reads)},
+        {"readahead stalls", static_cast<double>(stalls)},
+        {"readahead stall ms", static_cast<double>(stall_ns) / 1e6},
+        {"readahead restarts", static_cast<double>(restarts)},
+        {"readahead mean in flight KiB", kib(mean_in_flight)},
+        {"readahead peak in flight KiB", kib(static_cast<double>(peak_in_flight_bytes))},
+    };
+}
+#else
+ReadaheadIo::ReadaheadIo(const std::string &, const InputIoConfig &) {
+    throw std::runtime_error("Readahead input is not supported on this platform.");
+}
+
+ReadaheadIo::~ReadaheadIo() = default;
+
+int ReadaheadIo::read_cb(void *, std::uint8_t *, int) {
+    return AVERROR(ENOSYS);
+}
+
+std::int64_t ReadaheadIo::seek_cb(void *, std::int64_t, int) {
+    return AVERROR(ENOSYS);
+}
+
+InputIoStats ReadaheadIo::stats() const {
+    return {};
+}
+#endif
+}  // namespace splayer
@@ -0,0 +1,122 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef READAHEAD_IO_H_
+#define READAHEAD_IO_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <splayer/util/pf_wrapper.h>
+
+#include "input_io.h"
+
+namespace splayer {
+class ReadEngine;
+
+struct ReadCompletion {
+    std::size_t tag;
+    // Bytes read or negative errno
+    std::int64_t res;
+};
+
+// Keeps a window of fixed size blocks ahead of the demuxer in flight, so that on a cold page cache
+// (or a slow network mount) `av_read_frame` finds its data already read instead of blocking on
+// the disk. Reads are issued through io_uring where the kernel allows it and through a small pool
+// of pread threads otherwise.
+//
+// Demuxing sequentially recycles each block as soon as the demuxer moves past it. A seek outside
+// the window waits for the reads still in flight and refills the whole window at the new position.
+class ReadaheadIo final : public InputIo {
+public:
+    ReadaheadIo(const std::string &path, const InputIoConfig &cfg);
+    ReadaheadIo(const ReadaheadIo &) = delete;
+    ReadaheadIo &operator=(const ReadaheadIo &) = delete;
+    ~ReadaheadIo() override;
+
+    AVIOContext *avio() noexcept override { return ctx.get(); }
+    InputIoStats stats() const override;
+
+private:
+    struct Block {
+        std::unique_ptr<std::uint8_t[]> data;
+        std::int64_t off{};
+        // Bytes requested and bytes read so far, reads past the end of the file request less
+        std::size_t want{};
+        std::size_t filled{};
+        // Negative errno of a failed read
+        int error{};
+        bool in_flight{false};
+    };
+
+    static int read_cb(void *opaque, std::uint8_t *buf, int size);
+    static std::int64_t seek_cb(void *opaque, std::int64_t offset, int whence);
+
+    int read(std::uint8_t *buf, int size);
+    // Drops the window and refills it starting at the block containing `at`.
+    void restart(std::int64_t at);
+    // Recycles the blocks the demuxer has moved past for the ones after the window.
+    void advance();
+    void submit(std::size_t idx);
+    void complete(std::size_t idx, std::int64_t res);
+    // Hands finished reads to `complete`, blocking for at least one if `wait`.
+    void reap(bool wait);
+    void wait_for(std::size_t idx);
+    void drain();
+
+    // Size of the AVIOContext buffer, only used for the demuxer's small header reads
+    static constexpr int IO_BUF_SIZE = 64 * 1024;
+
+    // Outlives the engine reading from it
+    utils::UniqueFd fd;
+    std::int64_t file_size{};
+    std::size_t block_bytes{};
+
+    // Ring of blocks, `head` holds the one starting at `window_beg`
+    std::vector<Block> blocks;
+    std::size_t head{};
+    std::int64_t window_beg{};
+    std::int64_t pos{};
+
+    std::size_t in_flight_blocks{};
+    std::size_t in_flight_bytes{};
+
+    // Declared after the blocks so it's torn down before the memory it reads into
+    std::unique_ptr<ReadEngine> engine;
+    bool uring{false};
+    std::vector<ReadCompletion> reaped;
+
+    std::uint64_t reads{};
+    std::uint64_t stalls{};
+    std::int64_t stall_ns{};
+    std::uint64_t restarts{};
+    std::size_t peak_in_flight_bytes{};
+    double in_flight_bytes_sum{};
+
+    AVIOContextPtr ctx;
+};
+}  // namespace splayer
+
+#endif /* READAHEAD_IO_H_ */
@@ -0,0 +1,77 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef COLOR_SPACE_H_
+#define COLOR_SPACE_H_
+
+#include <array>
+
+namespace graphics {
+enum class ColorStandard { BT601, BT709, BT2020 };
+enum class ColorRange {
+    // 8-bit luma in [16, 235], chroma in [16, 240]
+    LIMITED,
+    // 8-bit luma and chroma in [0, 255]
+    FULL
+};
+
+// rgb = matrix * (yuv - offset), with yuv normalised to [0, 1] as sampled from the plane textures.
+struct YuvMatrix {
+    std::array<float, 9> m;  // row-major
+    std::array<float, 3> offset;
+};
+
+constexpr YuvMatrix yuv_to_rgb_matrix(ColorStandard standard, ColorRange range) noexcept {
+    float kr{}, kb{};
+
+    switch (standard) {
+        case ColorStandard::BT601:
+            kr = 0.299F;
+            kb = 0.114F;
+            break;
+        case ColorStandard::BT709:
+            kr = 0.2126F;
+            kb = 0.0722F;
+            break;
+        case ColorStandard::BT2020:
+            kr = 0.2627F;
+            kb = 0.0593F;
+            break;
+    }
+
+    const float kg = 1.0F - kr - kb;
+    const bool full = (range == ColorRange::FULL);
+    const float ys = full ? 1.0F : (255.0F / 219.0F);
+    const float cs = full ? 1.0F : (255.0F / 224.0F);
+    const float y_off = full ? 0.0F : (16.0F / 255.0F);
+    const float c_off = 128.0F / 255.0F;
+
+    const float r_v = 2.0F * (1.0F - kr) * cs;
+    const float g_u = -2.0F * kb * (1.0F - kb) / kg * cs;
+    const float g_v = -2.0F * kr * (1.0F - kr) / kg * cs;
+    const float b_u = 2.0F * (1.0F - kb) * cs;
+
+    return {{ys, 0.0F, r_v, ys, g_u, g_v, ys, b_u, 0.0F}, {y_off, c_off, c_off}};
+}
+}  // namespace graphics
+
+#endif /* COLOR_SPACE_H_ */
@@ -22,22 +22,71 @@
 
 #include "gl_texture.h"
 
+#include <splayer/util/log.h>
+#include <splayer/util/profiler.h>
+
+#include <cstdint>
+#include <cstring>
 #include <utility>
 
 namespace graphics {
+namespace {
+struct GlFormat {
+    GLint internal_fmt;
+    GLenum fmt;
+    GLint filter;
+};
+
+// Planes are sampled at a different resolution than the output, so they get linear filtering.
+constexpr GlFormat gl_format(TexFormat f) noexcept {
+    switch (f) {
+        case TexFormat::RGB:
+            return {GL_RGB, GL_RGB, GL_NEAREST};
+        case TexFormat::R8:
+            return {GL_R8, GL_RED, GL_LINEAR};
+        case TexFormat::RG8:
+            return {GL_RG8, GL_RG, GL_LINEAR};
+    }
+
+    return {GL_RGB, GL_RGB, GL_NEAREST};
+}
+
+constexpr GLint bytes_per_pixel(TexFormat f) noexcept {
+    switch (f) {
+        case TexFormat::RGB:
+            return 3;
+        case TexFormat::R8:
+            return 1;
+        case TexFormat::RG8:
+            return 2;
+    }
 
-GlTexture::GlTexture(size_type width, size_type height) { regen_texture(width, height); }
+    return 3;
+}
+}  // namespace
+
+GlTexture::GlTexture(size_type width, size_type height, TexFormat format) : tex_format(format) {
+    regen_texture(width, height);
+}
 
 GlTexture::GlTexture(GlTexture &&o) noexcept
     : tex_id{std::exchange(o.tex_id, NULL_TEXTURE)},
       tex_width{o.tex_width},
-      tex_height{o.tex_height} {}
+      tex_height{o.tex_height},
+      tex_format{o.tex_format},
+      stream_ring_size{o.stream_ring_size},
+      stream{std::move(o.stream)},
+      retired_stats{o.retired_stats} {}
 
 GlTexture &GlTexture::operator=(GlTexture &&o) noexcept {
     if (this != &o) {
         tex_id = std::exchange(o.tex_id, NULL_TEXTURE);
         tex_width = o.tex_width;
         tex_height = o.tex_height;
+        tex_format = o.tex_format;
+        stream_ring_size = o.stream_ring_size;
+        stream = std::move(o.stream);
+        retired_stats = o.retired_stats;
     }
 
     return *this;
@@ -52,6 +101,107 @@ void GlTexture::regen_texture(int width, int height) noexcept {
     create_new_texture(width, height);
 }
 
+void GlTexture::enable_streaming(std::size_t ring_size) noexcept {
+    stream_ring_size = ring_size;
+    if (stream) {
+        retired_stats += stream->stats();
+    }
+    stream.reset();
+
+    // Nothing to size the buffers by yet, the ring is created once `regen_texture` sets a size
+    if (tex_width <= 0 || tex_height <= 0) {
+        return;
+    }
+
+    const auto row_bytes = static_cast<std::size_t>(tex_width * bytes_per_pixel(tex_format));
+
+    // The requested ring size is kept on failure, so the next `regen_texture` tries again
+    try {
+        stream =
+            std::make_unique<PboRing>(ring_size, row_bytes * static_cast<std::size_t>(tex_height));
+    } catch (const std::exception &e) {
+        utils::Log(utils::Log::ERROR) << "Texture streaming unavailable, uploading directly: "
+                                      << e.what();
+    }
+}
+
+std::optional<PboRing::Stats> GlTexture::stream_stats() const noexcept {
+    if (!stream && retired_stats.uploads == 0) {
+        return std::nullopt;
+    }
+
+    auto st = retired_stats;
+    if (stream) {
+        st += stream->stats();
+    }
+
+    return st;
+}
+
+void GlTexture::upload_streamed(const void *data, size_type stride) {
+    const auto glf = gl_format(tex_format);
+    const auto row_bytes = static_cast<std::size_t>(tex_width * bytes_per_pixel(tex_format));
+    const auto src_stride = static_cast<std::size_t>(stride);
+
+    // Pack tightly into the pixel buffer, one copy instead of the driver's copy on submission.
+    auto *dst = static_cast<std::uint8_t *>(stream->begin_write());
+    const auto *src = static_cast<const std::uint8_t *>(data);
+
+    if (src_stride == row_bytes) {
+        std::memcpy(dst, src, row_bytes * static_cast<std::size_t>(tex_height));
+    } else {
+        for (size_type y = 0; y < tex_height; ++y) {
+            std::memcpy(dst, src, row_bytes);
+            dst += row_bytes;
+            src += src_stride;
+        }
+    }
+
+    stream->end_write();
+
+    bind();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(
+        GL_TEXTURE_2D, 0, 0, 0, tex_width, tex_height, glf.fmt, GL_UNSIGNED_BYTE, nullptr);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    unbind();
+
+    stream->finish_upload();
+}
+
+void GlTexture::upload(const void *data, size_type stride) {
+    PROF_ZONE(TEXTURE_UPLOAD);
+
+    if (stream) {
+        upload_streamed(data, stride);
+        return;
+    }
+
+    const auto glf = gl_format(tex_format);
+    const auto bpp = bytes_per_pixel(tex_format);
+
+    bind();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (stride % bpp == 0) {
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, stride / bpp);
+        glTexSubImage2D(
+            GL_TEXTURE_2D, 0, 0, 0, tex_width, tex_height, glf.fmt, GL_UNSIGNED_BYTE, data);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    } else {
+        // The row length is counted in pixels, so a stride that isn't a whole number of them (e.g.
+        // RGB24 lines padded to 32 bytes) can only be honoured one row at a time.
+        const auto *row = static_cast<const std::uint8_t *>(data);
+        for (size_type y = 0; y < tex_height; ++y) {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, tex_width, 1, glf.fmt, GL_UNSIGNED_BYTE, row);
+            row += stride;
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    unbind();
+}
+
 void GlTexture::try_delete_texture() noexcept {
     if (tex_id > 0) {
         glDeleteTextures(1, &tex_id);
@@ -63,17 +213,24 @@ void GlTexture::try_delete_texture() noexcept {
 void GlTexture::create_new_texture(int width, int height) noexcept {
     try_delete_texture();
 
+    const auto glf = gl_format(tex_format);
+
     glGenTextures(1, &tex_id);
     glBindTexture(GL_TEXTURE_2D, tex_id);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+    glTexImage2D(GL_TEXTURE_2D, 0, glf.internal_fmt, width, height, 0, glf.fmt, GL_UNSIGNED_BYTE,
+        nullptr);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, glf.filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, glf.filter);
     glBindTexture(GL_TEXTURE_2D, 0);
 
     tex_width = width;
     tex_height = height;
+
+    if (stream_ring_size > 0) {
+        enable_streaming(stream_ring_size);
+    }
 }
 
 GlTexture::~GlTexture() { try_delete_texture(); }
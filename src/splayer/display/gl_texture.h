@@ -25,15 +25,28 @@
 
 #include <GL/glew.h>
 
+#include <cstddef>
+#include <memory>
+#include <optional>
 #include <tuple>
 
+#include "pbo_ring.h"
+
 namespace graphics {
+enum class TexFormat {
+    RGB,
+    // Single 8-bit channel, e.g. a luma or chroma plane.
+    R8,
+    // Two interleaved 8-bit channels, e.g. the NV12 chroma plane.
+    RG8
+};
+
 class GlTexture final {
 public:
     using size_type = int;
     using tex_type = GLuint;
 
-    GlTexture(size_type width, size_type height);
+    GlTexture(size_type width, size_type height, TexFormat format = TexFormat::RGB);
     GlTexture(const GlTexture &) = delete;
     GlTexture &operator=(const GlTexture &) = delete;
     GlTexture(GlTexture &&) noexcept;
@@ -43,15 +56,33 @@ public:
     void bind() const noexcept;
     void unbind() const noexcept;
     void regen_texture(size_type width, size_type height) noexcept;
+    // Replaces the whole texture image, `stride` is the source row pitch in bytes.
+    void upload(const void *data, size_type stride);
+    // Routes subsequent uploads through a ring of `ring_size` pixel buffers so they don't block
+    // on the driver copying out of client memory. Survives `regen_texture`; falls back to direct
+    // uploads while the texture is empty or the buffers can't be created, and tries again on the
+    // next `regen_texture`.
+    void enable_streaming(std::size_t ring_size = DEFAULT_STREAM_RING) noexcept;
+    // Totals over every ring this texture streamed through, empty if it never streamed
+    std::optional<PboRing::Stats> stream_stats() const noexcept;
     std::tuple<size_type, size_type> dimensions() const { return {tex_width, tex_height}; }
+    TexFormat format() const noexcept { return tex_format; }
+
+    static constexpr std::size_t DEFAULT_STREAM_RING = 3;
 
 private:
     static constexpr auto NULL_TEXTURE = 0;
     void try_delete_texture() noexcept;
     void create_new_texture(size_type width, size_type height) noexcept;
+    void upload_streamed(const void *data, size_type stride);
 
     tex_type tex_id{NULL_TEXTURE};
     size_type tex_width, tex_height;
+    TexFormat tex_format;
+    std::size_t stream_ring_size{};
+    std::unique_ptr<PboRing> stream;
+    // Of rings replaced by `regen_texture`
+    PboRing::Stats retired_stats{};
 };
 }  // namespace graphics
 
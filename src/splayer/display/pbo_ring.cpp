@@ -0,0 +1,165 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pbo_ring.h"
+
+#include <splayer/util/pf_wrapper.h>
+
+#include <stdexcept>
+
+namespace graphics {
+PboRing::PboRing(std::size_t count, std::size_t buffer_size)
+    : slots(count), buf_size(buffer_size) {
+    persistent_map = GLEW_ARB_buffer_storage;
+    use_fences = GLEW_ARB_sync;
+
+    // Without fences a persistently mapped buffer can't be reused safely.
+    if (!use_fences) {
+        persistent_map = false;
+    }
+
+    const auto size = static_cast<GLsizeiptr>(buf_size);
+
+    try {
+        for (auto &s : slots) {
+            glGenBuffers(1, &s.pbo);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s.pbo);
+
+            if (persistent_map) {
+                constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT |
+                                             GL_MAP_COHERENT_BIT;
+                glBufferStorage(GL_PIXEL_UNPACK_BUFFER, size, nullptr, flags);
+                s.mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, flags);
+
+                if (s.mapped == nullptr) {
+                    throw std::runtime_error("Failed to persistently map pixel buffer");
+                }
+            } else {
+                glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+            }
+        }
+    } catch (...) {
+        // The destructor won't run, the buffers made so far would leak
+        release_slots();
+        throw;
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void PboRing::wait_fence(Slot &s) {
+    if (s.fence == nullptr) {
+        return;
+    }
+
+    GLenum status = glClientWaitSync(s.fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        const auto beg = utils::gettime_highres();
+
+        do {
+            status = glClientWaitSync(s.fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_NS);
+        } while (status == GL_TIMEOUT_EXPIRED);
+
+        stream_stats.fence_waits += 1;
+        stream_stats.fence_wait_ns += static_cast<std::uint64_t>(utils::gettime_highres() - beg);
+    }
+
+    glDeleteSync(s.fence);
+    s.fence = nullptr;
+}
+
+void *PboRing::begin_write() {
+    auto &s = slots[index];
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s.pbo);
+
+    if (persistent_map) {
+        wait_fence(s);
+        return s.mapped;
+    }
+
+    const auto size = static_cast<GLsizeiptr>(buf_size);
+    GLbitfield flags = GL_MAP_WRITE_BIT;
+
+    if (use_fences) {
+        wait_fence(s);
+        flags |= GL_MAP_UNSYNCHRONIZED_BIT;
+    } else {
+        // Let the driver hand us fresh storage instead of stalling on the previous contents.
+        flags |= GL_MAP_INVALIDATE_BUFFER_BIT;
+    }
+
+    s.mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, flags);
+    if (s.mapped == nullptr) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        throw std::runtime_error("Failed to map pixel buffer");
+    }
+
+    return s.mapped;
+}
+
+void PboRing::end_write() noexcept {
+    auto &s = slots[index];
+
+    if (!persistent_map) {
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        s.mapped = nullptr;
+    }
+}
+
+void PboRing::finish_upload() noexcept {
+    auto &s = slots[index];
+
+    if (use_fences) {
+        s.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    stream_stats.uploads += 1;
+    index = (index + 1) % slots.size();
+}
+
+void PboRing::release_slots() noexcept {
+    for (auto &s : slots) {
+        if (s.fence != nullptr) {
+            glDeleteSync(s.fence);
+            s.fence = nullptr;
+        }
+
+        if (persistent_map && s.mapped != nullptr) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s.pbo);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            s.mapped = nullptr;
+        }
+
+        if (s.pbo != 0) {
+            glDeleteBuffers(1, &s.pbo);
+            s.pbo = 0;
+        }
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+PboRing::~PboRing() { release_slots(); }
+}  // namespace graphics
@@ -0,0 +1,91 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PBO_RING_H_
+#define PBO_RING_H_
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace graphics {
+// Ring of pixel unpack buffers used to stream texture uploads. While the GPU is still copying out
+// of one buffer the CPU already fills the next one; a fence per buffer guards against reuse before
+// the copy finished. Buffers are persistently mapped when ARB_buffer_storage is available and
+// mapped unsynchronised per upload otherwise.
+class PboRing final {
+public:
+    struct Stats {
+        std::uint64_t uploads;
+        // Uploads that had to block on the GPU still reading the next buffer.
+        std::uint64_t fence_waits;
+        std::uint64_t fence_wait_ns;
+
+        Stats &operator+=(const Stats &o) noexcept {
+            uploads += o.uploads;
+            fence_waits += o.fence_waits;
+            fence_wait_ns += o.fence_wait_ns;
+            return *this;
+        }
+    };
+
+    PboRing(std::size_t count, std::size_t buffer_size);
+    PboRing(const PboRing &) = delete;
+    PboRing &operator=(const PboRing &) = delete;
+    ~PboRing();
+
+    // Returns `buffer_size` writable bytes for the next upload.
+    void *begin_write();
+    // Leaves the written buffer bound to GL_PIXEL_UNPACK_BUFFER for the texture upload.
+    void end_write() noexcept;
+    // Call after issuing the texture upload that sources from the bound buffer.
+    void finish_upload() noexcept;
+
+    bool persistent() const noexcept { return persistent_map; }
+    std::size_t size() const noexcept { return buf_size; }
+    Stats stats() const noexcept { return stream_stats; }
+
+private:
+    struct Slot {
+        GLuint pbo{};
+        GLsync fence{};
+        void *mapped{};
+    };
+
+    void wait_fence(Slot &s);
+    // Unmaps and deletes whatever buffers and fences exist, also on a failed construction.
+    void release_slots() noexcept;
+
+    static constexpr GLuint64 FENCE_WAIT_NS = 1000000;
+
+    std::vector<Slot> slots;
+    std::size_t buf_size;
+    std::size_t index{};
+    bool persistent_map{};
+    bool use_fences{};
+    Stats stream_stats{};
+};
+}  // namespace graphics
+
+#endif /* PBO_RING_H_ */
@@ -0,0 +1,60 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "rgb_renderer.h"
+
+#include <string_view>
+
+namespace graphics {
+namespace {
+constexpr std::string_view RGB_FRAGMENT_SHADER = R"(#version 330 core
+uniform sampler2D frame;
+in vec2 tex_coord;
+out vec4 frag_color;
+
+void main() {
+    frag_color = vec4(texture(frame, tex_coord).rgb, 1.0);
+}
+)";
+}  // namespace
+
+RgbRenderer::RgbRenderer() : program(VIDEO_QUAD_VERTEX_SHADER, RGB_FRAGMENT_SHADER) {
+    program.use();
+    glUniform1i(program.uniform_location("frame"), 0);
+    program.unuse();
+
+    loc_scale = program.uniform_location("quad_scale");
+}
+
+void RgbRenderer::bind(const GlTexture &tex, const QuadScale &scale) const noexcept {
+    program.use();
+    glUniform2fv(loc_scale, 1, scale.data());
+
+    glActiveTexture(GL_TEXTURE0);
+    tex.bind();
+}
+
+void RgbRenderer::unbind(const GlTexture &tex) const noexcept {
+    tex.unbind();
+    program.unuse();
+}
+}  // namespace graphics
@@ -0,0 +1,47 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef RGB_RENDERER_H_
+#define RGB_RENDERER_H_
+
+#include "gl_texture.h"
+#include "shader_program.h"
+#include "video_quad.h"
+
+namespace graphics {
+// Draws packed RGB frames, already converted on the CPU, straight from their texture.
+class RgbRenderer final {
+public:
+    RgbRenderer();
+
+    // Binds the program and `tex` for the following `VideoQuad::draw`.
+    void bind(const GlTexture &tex, const QuadScale &scale) const noexcept;
+    void unbind(const GlTexture &tex) const noexcept;
+
+private:
+    ShaderProgram program;
+
+    GLint loc_scale{};
+};
+}  // namespace graphics
+
+#endif /* RGB_RENDERER_H_ */
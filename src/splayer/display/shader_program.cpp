@@ -0,0 +1,114 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "shader_program.h"
+
+#include <splayer/util/log.h>
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace graphics {
+GLuint ShaderProgram::compile_shader(GLenum type, std::string_view src) {
+    const GLuint shader = glCreateShader(type);
+    const GLchar *src_data = src.data();
+    const auto src_len = static_cast<GLint>(src.size());
+
+    glShaderSource(shader, 1, &src_data, &src_len);
+    glCompileShader(shader);
+
+    GLint status{};
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE) {
+        std::string info(1024, '\0');
+        glGetShaderInfoLog(shader, static_cast<GLsizei>(info.size()), nullptr, info.data());
+        glDeleteShader(shader);
+
+        utils::Log(utils::Log::ERROR) << "Shader compilation failed: " << info.c_str();
+        throw std::runtime_error("Failed to compile shader");
+    }
+
+    return shader;
+}
+
+ShaderProgram::ShaderProgram(std::string_view vertex_src, std::string_view fragment_src) {
+    const GLuint vs = compile_shader(GL_VERTEX_SHADER, vertex_src);
+    GLuint fs{};
+
+    try {
+        fs = compile_shader(GL_FRAGMENT_SHADER, fragment_src);
+    } catch (...) {
+        glDeleteShader(vs);
+        throw;
+    }
+
+    program_id = glCreateProgram();
+    glAttachShader(program_id, vs);
+    glAttachShader(program_id, fs);
+    glLinkProgram(program_id);
+
+    // The program keeps its own reference to the attached shaders.
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    GLint status{};
+    glGetProgramiv(program_id, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        std::string info(1024, '\0');
+        glGetProgramInfoLog(program_id, static_cast<GLsizei>(info.size()), nullptr, info.data());
+        try_delete_program();
+
+        utils::Log(utils::Log::ERROR) << "Shader program link failed: " << info.c_str();
+        throw std::runtime_error("Failed to link shader program");
+    }
+}
+
+ShaderProgram::ShaderProgram(ShaderProgram &&o) noexcept
+    : program_id{std::exchange(o.program_id, NULL_PROGRAM)} {}
+
+ShaderProgram &ShaderProgram::operator=(ShaderProgram &&o) noexcept {
+    if (this != &o) {
+        try_delete_program();
+        program_id = std::exchange(o.program_id, NULL_PROGRAM);
+    }
+
+    return *this;
+}
+
+void ShaderProgram::use() const noexcept { glUseProgram(program_id); }
+
+void ShaderProgram::unuse() const noexcept { glUseProgram(0); }
+
+GLint ShaderProgram::uniform_location(const char *name) const noexcept {
+    return glGetUniformLocation(program_id, name);
+}
+
+void ShaderProgram::try_delete_program() noexcept {
+    if (program_id > 0) {
+        glDeleteProgram(program_id);
+        program_id = NULL_PROGRAM;
+    }
+}
+
+ShaderProgram::~ShaderProgram() { try_delete_program(); }
+}  // namespace graphics
@@ -0,0 +1,55 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SHADER_PROGRAM_H_
+#define SHADER_PROGRAM_H_
+
+#include <GL/glew.h>
+
+#include <string_view>
+
+namespace graphics {
+class ShaderProgram final {
+public:
+    using program_type = GLuint;
+
+    ShaderProgram(std::string_view vertex_src, std::string_view fragment_src);
+    ShaderProgram(const ShaderProgram &) = delete;
+    ShaderProgram &operator=(const ShaderProgram &) = delete;
+    ShaderProgram(ShaderProgram &&) noexcept;
+    ShaderProgram &operator=(ShaderProgram &&) noexcept;
+    ~ShaderProgram();
+
+    void use() const noexcept;
+    void unuse() const noexcept;
+    GLint uniform_location(const char *name) const noexcept;
+
+private:
+    static constexpr auto NULL_PROGRAM = 0;
+    static GLuint compile_shader(GLenum type, std::string_view src);
+    void try_delete_program() noexcept;
+
+    program_type program_id{NULL_PROGRAM};
+};
+}  // namespace graphics
+
+#endif /* SHADER_PROGRAM_H_ */
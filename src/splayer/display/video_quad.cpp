@@ -0,0 +1,116 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "video_quad.h"
+
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+namespace graphics {
+namespace {
+struct QuadVertex {
+    GLfloat x, y;
+    GLfloat u, v;
+};
+
+// Triangle strip, clip space is y up while textures start at the top row
+constexpr std::array<QuadVertex, 4> QUAD_VERTICES{{
+    {-1.0f, 1.0f, 0.0f, 0.0f},
+    {-1.0f, -1.0f, 0.0f, 1.0f},
+    {1.0f, 1.0f, 1.0f, 0.0f},
+    {1.0f, -1.0f, 1.0f, 1.0f},
+}};
+}  // namespace
+
+VideoQuad::VideoQuad() {
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    if (vao == NULL_OBJECT || vbo == NULL_OBJECT) {
+        try_delete();
+        throw std::runtime_error("Failed to create the video quad buffers");
+    }
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(QUAD_VERTICES), QUAD_VERTICES.data(), GL_STATIC_DRAW);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(QuadVertex),
+        reinterpret_cast<const void *>(offsetof(QuadVertex, x)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(QuadVertex),
+        reinterpret_cast<const void *>(offsetof(QuadVertex, u)));
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+VideoQuad::VideoQuad(VideoQuad &&o) noexcept
+    : vao{std::exchange(o.vao, NULL_OBJECT)}, vbo{std::exchange(o.vbo, NULL_OBJECT)} {}
+
+VideoQuad &VideoQuad::operator=(VideoQuad &&o) noexcept {
+    if (this != &o) {
+        try_delete();
+        vao = std::exchange(o.vao, NULL_OBJECT);
+        vbo = std::exchange(o.vbo, NULL_OBJECT);
+    }
+
+    return *this;
+}
+
+void VideoQuad::draw() const noexcept {
+    glBindVertexArray(vao);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, static_cast<GLsizei>(QUAD_VERTICES.size()));
+    glBindVertexArray(0);
+}
+
+QuadScale VideoQuad::letterbox_scale(int frame_w, int frame_h, int view_w, int view_h) noexcept {
+    if (frame_w <= 0 || frame_h <= 0 || view_w <= 0 || view_h <= 0) {
+        return {1.0f, 1.0f};
+    }
+
+    const double frame_aspect = static_cast<double>(frame_w) / frame_h;
+    const double view_aspect = static_cast<double>(view_w) / view_h;
+
+    // Wider than the viewport: bars above and below, otherwise on the left and right
+    if (frame_aspect > view_aspect) {
+        return {1.0f, static_cast<GLfloat>(view_aspect / frame_aspect)};
+    }
+
+    return {static_cast<GLfloat>(frame_aspect / view_aspect), 1.0f};
+}
+
+void VideoQuad::try_delete() noexcept {
+    if (vao != NULL_OBJECT) {
+        glDeleteVertexArrays(1, &vao);
+        vao = NULL_OBJECT;
+    }
+
+    if (vbo != NULL_OBJECT) {
+        glDeleteBuffers(1, &vbo);
+        vbo = NULL_OBJECT;
+    }
+}
+
+VideoQuad::~VideoQuad() { try_delete(); }
+}  // namespace graphics
@@ -0,0 +1,75 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef VIDEO_QUAD_H_
+#define VIDEO_QUAD_H_
+
+#include <GL/glew.h>
+
+#include <array>
+#include <string_view>
+
+namespace graphics {
+// Horizontal and vertical scale of the quad relative to the viewport
+using QuadScale = std::array<GLfloat, 2>;
+
+// Vertex stage shared by the video shaders. Takes the quad corners at attribute 0 and their
+// texture coordinates at attribute 1, and shrinks the quad by the `quad_scale` uniform.
+inline constexpr std::string_view VIDEO_QUAD_VERTEX_SHADER = R"(#version 330 core
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 uv;
+uniform vec2 quad_scale;
+out vec2 tex_coord;
+
+void main() {
+    tex_coord = uv;
+    gl_Position = vec4(position * quad_scale, 0.0, 1.0);
+}
+)";
+
+// The viewport filling quad every frame is drawn with, kept in a static vertex buffer. The top left
+// corner samples the first row of the texture.
+class VideoQuad final {
+public:
+    VideoQuad();
+    VideoQuad(const VideoQuad &) = delete;
+    VideoQuad &operator=(const VideoQuad &) = delete;
+    VideoQuad(VideoQuad &&) noexcept;
+    VideoQuad &operator=(VideoQuad &&) noexcept;
+    ~VideoQuad();
+
+    // Draws with whatever program and textures are bound.
+    void draw() const noexcept;
+
+    // Fits a `frame_w` x `frame_h` picture into the viewport without distorting it, leaving bars on
+    // the sides that don't match.
+    static QuadScale letterbox_scale(int frame_w, int frame_h, int view_w, int view_h) noexcept;
+
+private:
+    static constexpr GLuint NULL_OBJECT = 0;
+    void try_delete() noexcept;
+
+    GLuint vao{NULL_OBJECT}, vbo{NULL_OBJECT};
+};
+}  // namespace graphics
+
+#endif /* VIDEO_QUAD_H_ */
@@ -0,0 +1,165 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "yuv_renderer.h"
+
+#include <splayer/util/log.h>
+
+#include <stdexcept>
+#include <string_view>
+
+namespace graphics {
+namespace {
+constexpr std::string_view YUV_FRAGMENT_SHADER = R"(#version 330 core
+uniform sampler2D plane_y;
+uniform sampler2D plane_u;
+uniform sampler2D plane_v;
+uniform bool semi_planar;
+uniform mat3 yuv_matrix;
+uniform vec3 yuv_offset;
+in vec2 tex_coord;
+out vec4 frag_color;
+
+void main() {
+    vec3 yuv;
+    yuv.x = texture(plane_y, tex_coord).r;
+
+    if (semi_planar) {
+        yuv.yz = texture(plane_u, tex_coord).rg;
+    } else {
+        yuv.y = texture(plane_u, tex_coord).r;
+        yuv.z = texture(plane_v, tex_coord).r;
+    }
+
+    frag_color = vec4(clamp(yuv_matrix * (yuv - yuv_offset), 0.0, 1.0), 1.0);
+}
+)";
+}  // namespace
+
+YuvRenderer::YuvRenderer() : program(VIDEO_QUAD_VERTEX_SHADER, YUV_FRAGMENT_SHADER) {
+    // The planes are GL_R8/GL_RG8 textures, core from 3.0 and an extension on older contexts
+    if (!GLEW_VERSION_3_0 && !GLEW_ARB_texture_rg) {
+        utils::Log(utils::Log::ERROR) << "YUV rendering needs GL 3.0 or ARB_texture_rg.";
+        throw std::runtime_error("Single and two channel textures unsupported");
+    }
+
+    program.use();
+    glUniform1i(program.uniform_location("plane_y"), 0);
+    glUniform1i(program.uniform_location("plane_u"), 1);
+    glUniform1i(program.uniform_location("plane_v"), 2);
+    program.unuse();
+
+    loc_matrix = program.uniform_location("yuv_matrix");
+    loc_offset = program.uniform_location("yuv_offset");
+    loc_semi_planar = program.uniform_location("semi_planar");
+    loc_scale = program.uniform_location("quad_scale");
+}
+
+void YuvRenderer::regen_planes(int width, int height, bool nv12) {
+    const int cw = (width + 1) / 2;
+    const int ch = (height + 1) / 2;
+
+    // Same plane layout, only the stream resolution changed: resize the existing textures.
+    if (!planes.empty() && nv12 == semi_planar) {
+        planes[0].regen_texture(width, height);
+
+        for (std::size_t i = 1; i < planes.size(); ++i) {
+            planes[i].regen_texture(cw, ch);
+        }
+
+        return;
+    }
+
+    for (const auto &t : planes) {
+        if (const auto st = t.stream_stats()) {
+            retired_stats += *st;
+        }
+    }
+
+    planes.clear();
+    planes.emplace_back(width, height, TexFormat::R8);
+
+    if (nv12) {
+        planes.emplace_back(cw, ch, TexFormat::RG8);
+    } else {
+        planes.emplace_back(cw, ch, TexFormat::R8);
+        planes.emplace_back(cw, ch, TexFormat::R8);
+    }
+
+    for (auto &t : planes) {
+        t.enable_streaming();
+    }
+
+    semi_planar = nv12;
+}
+
+void YuvRenderer::upload(const YuvPlanes &p) {
+    if (planes.empty() || semi_planar != p.semi_planar ||
+        planes[0].dimensions() != std::tuple{p.width, p.height}) {
+        regen_planes(p.width, p.height, p.semi_planar);
+    }
+
+    for (std::size_t i = 0; i < planes.size(); ++i) {
+        planes[i].upload(p.data[i], p.linesize[i]);
+    }
+
+    matrix = yuv_to_rgb_matrix(p.standard, p.range);
+}
+
+std::optional<PboRing::Stats> YuvRenderer::stream_stats() const noexcept {
+    auto total = retired_stats;
+    bool streamed = (total.uploads > 0);
+
+    for (const auto &t : planes) {
+        if (const auto st = t.stream_stats()) {
+            total += *st;
+            streamed = true;
+        }
+    }
+
+    return streamed ? std::optional{total} : std::nullopt;
+}
+
+void YuvRenderer::bind(const QuadScale &scale) const noexcept {
+    program.use();
+    glUniform2fv(loc_scale, 1, scale.data());
+    glUniformMatrix3fv(loc_matrix, 1, GL_TRUE, matrix.m.data());
+    glUniform3fv(loc_offset, 1, matrix.offset.data());
+    glUniform1i(loc_semi_planar, semi_planar);
+
+    for (std::size_t i = 0; i < planes.size(); ++i) {
+        glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(i));
+        planes[i].bind();
+    }
+
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void YuvRenderer::unbind() const noexcept {
+    for (std::size_t i = planes.size(); i-- > 0;) {
+        glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(i));
+        planes[i].unbind();
+    }
+
+    program.unuse();
+}
+}  // namespace graphics
@@ -0,0 +1,75 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef YUV_RENDERER_H_
+#define YUV_RENDERER_H_
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "color_space.h"
+#include "gl_texture.h"
+#include "shader_program.h"
+#include "video_quad.h"
+
+namespace graphics {
+// One decoded picture as planes in client memory, 4:2:0 subsampled.
+struct YuvPlanes {
+    std::array<const std::uint8_t *, 3> data{};
+    std::array<int, 3> linesize{};
+    int width{}, height{};
+    // NV12: interleaved UV in plane 1, plane 2 unused
+    bool semi_planar{};
+    ColorStandard standard{ColorStandard::BT709};
+    ColorRange range{ColorRange::LIMITED};
+};
+
+// Uploads the native planes of a YUV picture into one texture each and converts them to RGB in a
+// fragment shader while drawing.
+class YuvRenderer final {
+public:
+    YuvRenderer();
+
+    void upload(const YuvPlanes &p);
+    // Binds the program and plane textures for the following `VideoQuad::draw`.
+    void bind(const QuadScale &scale) const noexcept;
+    void unbind() const noexcept;
+    // Summed over every plane texture so far, see `GlTexture::stream_stats`
+    std::optional<PboRing::Stats> stream_stats() const noexcept;
+
+private:
+    void regen_planes(int width, int height, bool semi_planar);
+
+    ShaderProgram program;
+    std::vector<GlTexture> planes;
+    bool semi_planar{};
+    YuvMatrix matrix{};
+    // Of plane textures dropped for a different layout
+    PboRing::Stats retired_stats{};
+
+    GLint loc_matrix{}, loc_offset{}, loc_semi_planar{}, loc_scale{};
+};
+}  // namespace graphics
+
+#endif /* YUV_RENDERER_H_ */
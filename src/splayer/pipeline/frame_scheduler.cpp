@@ -0,0 +1,107 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "frame_scheduler.h"
+
+#include <splayer/util/utils.h>
+
+using namespace utils;
+
+namespace splayer {
+FrameScheduler::FrameScheduler(FrameSource &src, AVRational time_base, double fps)
+    : source(src),
+      tb(time_base),
+      frame_duration(std::chrono::duration_cast<clock::duration>(
+          std::chrono::duration<double>(fps > 0.0 ? 1.0 / fps : 0.0))) {}
+
+FrameScheduler::clock::duration FrameScheduler::frame_pts(const AVFrame *f) const noexcept {
+    auto ts = f->best_effort_timestamp;
+    if (ts == AV_NOPTS_VALUE) {
+        ts = f->pts;
+    }
+
+    // Untimed frames are shown as soon as they're reached, one frame after the previous one.
+    if (ts == AV_NOPTS_VALUE) {
+        return last_pts + frame_duration;
+    }
+
+    return std::chrono::duration_cast<clock::duration>(
+        std::chrono::nanoseconds(av_rescale_q(ts, tb, AVRational{1, 1000000000})));
+}
+
+void FrameScheduler::anchor(clock::time_point now, clock::duration pts) noexcept {
+    origin = now - pts;
+    anchored = true;
+}
+
+PooledFramePtr FrameScheduler::next_frame(clock::time_point now) {
+    PooledFramePtr candidate;
+    clock::duration candidate_pts{};
+    // Whether the loop stopped because nothing was queued, rather than at a frame not due yet
+    bool drained{true};
+
+    while (const AVFrame *front = source.peek_frame()) {
+        const auto pts = frame_pts(front);
+
+        // First frame, or a jump in the timeline (seek, wrap-around, broken timestamps).
+        if (!anchored || pts < last_pts || pts - (now - origin) > MAX_DRIFT) {
+            if (anchored) {
+                SPLAYER_LOG(VERBOSE) << "Presentation clock re-anchored";
+            }
+
+            anchor(now, pts);
+        }
+
+        if (pts > now - origin) {
+            drained = false;
+            break;
+        }
+
+        if (candidate) {
+            sched_stats.dropped += 1;
+        }
+
+        candidate = source.pop_frame();
+        candidate_pts = pts;
+        last_pts = pts;
+    }
+
+    if (!candidate) {
+        // Only a miss if the next frame was due and hadn't arrived. Holding a frame until the next
+        // one's timestamp is the normal cadence when the display outpaces the stream (24 fps on
+        // 60 Hz), and holding the last one after the end isn't a miss either.
+        const bool due = (now - origin >= last_pts + frame_duration);
+        if (anchored && drained && due && !source.finished()) {
+            sched_stats.repeated += 1;
+        }
+
+        return candidate;
+    }
+
+    if ((now - origin) - candidate_pts > frame_duration) {
+        sched_stats.late += 1;
+    }
+
+    sched_stats.presented += 1;
+    return candidate;
+}
+}  // namespace splayer
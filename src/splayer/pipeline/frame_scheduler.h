@@ -0,0 +1,74 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FRAME_SCHEDULER_H_
+#define FRAME_SCHEDULER_H_
+
+#include <chrono>
+#include <cstdint>
+
+#include "frame_source.h"
+
+namespace splayer {
+// Presentation clock driven by frame timestamps. Called once per display refresh, it picks the
+// newest frame whose timestamp has been reached and drops any older ones that were never shown,
+// instead of sleeping to pace the render loop.
+class FrameScheduler final {
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct Stats {
+        std::uint64_t presented;
+        // Frames that became due but were superseded by a newer due frame before being shown.
+        std::uint64_t dropped;
+        // Refreshes that kept showing the previous frame because the next one was due but not
+        // converted yet.
+        std::uint64_t repeated;
+        // Presented frames that were more than one frame duration behind the clock.
+        std::uint64_t late;
+    };
+
+    FrameScheduler(FrameSource &src, AVRational time_base, double fps);
+
+    // Returns the frame to show at `now`, or an empty pointer to keep showing the current one.
+    PooledFramePtr next_frame(clock::time_point now = clock::now());
+    Stats stats() const noexcept { return sched_stats; }
+
+private:
+    clock::duration frame_pts(const AVFrame *f) const noexcept;
+    void anchor(clock::time_point now, clock::duration pts) noexcept;
+
+    // A timestamp further than this from the clock is treated as a discontinuity.
+    static constexpr auto MAX_DRIFT = std::chrono::seconds(1);
+
+    FrameSource &source;
+    AVRational tb;
+    clock::duration frame_duration;
+
+    bool anchored{false};
+    clock::time_point origin{};
+    clock::duration last_pts{};
+    Stats sched_stats{};
+};
+}  // namespace splayer
+
+#endif /* FRAME_SCHEDULER_H_ */
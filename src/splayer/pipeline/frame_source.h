@@ -0,0 +1,45 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FRAME_SOURCE_H_
+#define FRAME_SOURCE_H_
+
+#include <splayer/codec/decode/frame_pool.h>
+
+namespace splayer {
+// Consumer end of a stream of converted frames, as read by `FrameScheduler`. Both calls are
+// non-blocking and only ever made from the render thread.
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+
+    // Returns an empty pointer if no converted frame is ready yet. The frame returns to the
+    // decoder's pool once released.
+    virtual PooledFramePtr pop_frame() = 0;
+    // The frame `pop_frame` would return next, without removing it.
+    virtual const AVFrame *peek_frame() = 0;
+    // True once no more frames will arrive and the last one was popped.
+    virtual bool finished() const = 0;
+};
+}  // namespace splayer
+
+#endif /* FRAME_SOURCE_H_ */
@@ -0,0 +1,120 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "load_governor.h"
+
+#include <splayer/util/utils.h>
+
+#include <algorithm>
+
+using namespace utils;
+
+namespace splayer {
+LoadGovernor::LoadGovernor(Pipeline &p, Config c) : pipeline(&p), cfg(c), hold(c.recover_after) {}
+
+void LoadGovernor::step(DecodeQuality to, clock::time_point now) {
+    const bool degrade = (to > quality);
+
+    SPLAYER_LOG(INFO) << (degrade ? "Decoder falling behind" : "Decoder recovered")
+                      << ", switching from " << decode_quality_name(quality) << " to "
+                      << decode_quality_name(to);
+
+    if (degrade) {
+        gov_stats.degrades += 1;
+
+        // Stepping up just now was premature, wait longer before the next attempt
+        if (gov_stats.recoveries > 0 && now - last_recovery < hold) {
+            hold = std::min(hold * 2, cfg.max_recover_after);
+        }
+    } else {
+        gov_stats.recoveries += 1;
+        last_recovery = now;
+    }
+
+    quality = to;
+    pipeline->set_quality(to);
+    healthy_since = now;
+}
+
+void LoadGovernor::retarget(Pipeline &p) {
+    if (pipeline == &p) {
+        return;
+    }
+
+    pipeline = &p;
+    pipeline->set_quality(quality);
+    // Depths sampled from the old pipeline say nothing about the new one
+    depth_sum = depth_samples = 0;
+}
+
+void LoadGovernor::update(const FrameScheduler::Stats &s, clock::time_point now) {
+    if (!started) {
+        started = true;
+        window_beg = healthy_since = now;
+        window_sched = s;
+    }
+
+    const auto converted = pipeline->stats().converted;
+    depth_sum += converted.depth;
+    depth_samples += 1;
+
+    if (now - window_beg < cfg.window) {
+        return;
+    }
+
+    const auto shown = s.presented - window_sched.presented;
+    const auto behind = (s.late - window_sched.late) + (s.dropped - window_sched.dropped);
+    const double mean_depth = static_cast<double>(depth_sum) / static_cast<double>(depth_samples);
+
+    window_beg = now;
+    window_sched = s;
+    depth_sum = depth_samples = 0;
+
+    const bool late =
+        (static_cast<double>(behind) > cfg.late_ratio * static_cast<double>(shown + behind));
+    // Lateness with frames waiting is the renderer's doing, cheaper decoding won't help there
+    const bool starved = (mean_depth < 1.0);
+    const bool full = (mean_depth * 2.0 >= static_cast<double>(converted.capacity));
+
+    if (late && starved) {
+        if (quality != DecodeQuality::KEYFRAMES_ONLY) {
+            step(static_cast<DecodeQuality>(static_cast<int>(quality) + 1), now);
+        }
+
+        return;
+    }
+
+    if (late || !full) {
+        healthy_since = now;
+        return;
+    }
+
+    if (quality != DecodeQuality::FULL && now - healthy_since >= hold) {
+        step(static_cast<DecodeQuality>(static_cast<int>(quality) - 1), now);
+    }
+
+    // A long stretch at full quality means the load that caused the backoff is gone
+    if (quality == DecodeQuality::FULL && now - healthy_since >= cfg.max_recover_after) {
+        hold = cfg.recover_after;
+    }
+}
+}  // namespace splayer
@@ -0,0 +1,86 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef LOAD_GOVERNOR_H_
+#define LOAD_GOVERNOR_H_
+
+#include <chrono>
+#include <cstdint>
+
+#include "frame_scheduler.h"
+#include "pipeline.h"
+
+namespace splayer {
+// Trades decode quality for speed when playback falls behind. Fed once per refresh, it looks at
+// each window of refreshes: frames shown late or dropped while the converted queue runs dry mean
+// the decoder can't keep up, and the pipeline steps down one `DecodeQuality` level. Once the queue
+// stays full without lateness for `recover_after`, it steps back up one level.
+class LoadGovernor final {
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct Config {
+        clock::duration window{std::chrono::milliseconds(500)};
+        // Share of the frames due in a window that may be late or dropped
+        double late_ratio{0.1};
+        clock::duration recover_after{std::chrono::seconds(3)};
+        // Recovering right back into lateness doubles the hold, up to this
+        clock::duration max_recover_after{std::chrono::seconds(30)};
+    };
+
+    struct Stats {
+        std::uint64_t degrades;
+        std::uint64_t recoveries;
+    };
+
+    explicit LoadGovernor(Pipeline &p) : LoadGovernor(p, Config{}) {}
+    LoadGovernor(Pipeline &p, Config cfg);
+
+    void update(const FrameScheduler::Stats &s, clock::time_point now = clock::now());
+    // Governs `p` from now on, handing it the current level. A no-op for the pipeline already
+    // governed, so it can be called on every refresh.
+    void retarget(Pipeline &p);
+    DecodeQuality level() const noexcept { return quality; }
+    Stats stats() const noexcept { return gov_stats; }
+
+private:
+    void step(DecodeQuality to, clock::time_point now);
+
+    Pipeline *pipeline;
+    Config cfg;
+
+    DecodeQuality quality{DecodeQuality::FULL};
+    clock::duration hold;
+
+    bool started{false};
+    clock::time_point window_beg{};
+    FrameScheduler::Stats window_sched{};
+    // Converted queue depth summed over the refreshes of the window
+    std::size_t depth_sum{}, depth_samples{};
+
+    clock::time_point healthy_since{};
+    clock::time_point last_recovery{};
+    Stats gov_stats{};
+};
+}  // namespace splayer
+
+#endif /* LOAD_GOVERNOR_H_ */
@@ -0,0 +1,263 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pipeline.h"
+
+#include <splayer/util/memory_budget.h>
+#include <splayer/util/utils.h>
+
+#include <chrono>
+
+using namespace utils;
+
+namespace splayer {
+namespace {
+// Spin briefly before falling back to sleeping, queues are expected to turn over within a frame.
+void wait_backoff(unsigned &spins) {
+    constexpr unsigned YIELD_SPINS = 64;
+    constexpr auto IDLE_SLEEP = std::chrono::microseconds(250);
+
+    if (spins < YIELD_SPINS) {
+        spins += 1;
+        std::this_thread::yield();
+    } else {
+        std::this_thread::sleep_for(IDLE_SLEEP);
+    }
+}
+}  // namespace
+
+Pipeline::Pipeline(Decoder &dec, Depths depths)
+    : decoder(dec),
+      decoded_pool(depths.decoded + 2, FramePool::Mode::REFERENCE),
+      packet_pool(depths.packets + 2),
+      packet_q(depths.packets),
+      decoded_q(depths.decoded),
+      converted_q(depths.converted) {}
+
+void Pipeline::start() {
+    if (running.exchange(true)) {
+        return;
+    }
+
+    demux_th = std::thread(&Pipeline::run_stage, this, &Pipeline::demux_thread, std::ref(demux_done));
+    decode_th =
+        std::thread(&Pipeline::run_stage, this, &Pipeline::decode_thread, std::ref(decode_done));
+    convert_th =
+        std::thread(&Pipeline::run_stage, this, &Pipeline::convert_thread, std::ref(convert_done));
+}
+
+void Pipeline::stop() noexcept {
+    running.store(false, std::memory_order_release);
+
+    for (auto *th : {&demux_th, &decode_th, &convert_th}) {
+        if (th->joinable()) {
+            th->join();
+        }
+    }
+}
+
+PooledFramePtr Pipeline::pop_frame() {
+    PooledFramePtr f;
+    converted_q.try_pop(f);
+    return f;
+}
+
+const AVFrame *Pipeline::peek_frame() {
+    const auto *f = converted_q.front();
+    return (f != nullptr ? f->get() : nullptr);
+}
+
+bool Pipeline::finished() const noexcept {
+    return convert_done.load(std::memory_order_acquire) && converted_q.empty();
+}
+
+Pipeline::Stats Pipeline::stats() const noexcept {
+    return {queue_stats(packet_q), queue_stats(decoded_q), queue_stats(converted_q)};
+}
+
+template <typename T>
+bool Pipeline::push_wait(utils::SpscQueue<T> &q, T &&v) {
+    unsigned spins{};
+
+    while (!q.try_push(std::move(v))) {
+        if (!running.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        wait_backoff(spins);
+    }
+
+    return true;
+}
+
+void Pipeline::run_stage(void (Pipeline::*stage)(), std::atomic<bool> &done_flag) noexcept {
+    try {
+        (this->*stage)();
+    } catch (const DecoderError &e) {
+        Log(Log::ERROR) << "Pipeline stage failed: " << e.error_string();
+        failed_.store(true, std::memory_order_release);
+    } catch (const std::exception &e) {
+        Log(Log::ERROR) << "Pipeline stage failed: " << e.what();
+        failed_.store(true, std::memory_order_release);
+    }
+
+    done_flag.store(true, std::memory_order_release);
+}
+
+void Pipeline::demux_thread() {
+    unsigned spins{};
+
+    while (running.load(std::memory_order_acquire)) {
+        // Every shell is queued or being decoded, wait for the decode thread.
+        auto pkt = packet_pool.acquire();
+        if (!pkt) {
+            wait_backoff(spins);
+            continue;
+        }
+
+        spins = 0;
+
+        if (!decoder.read_packet(pkt.get())) {
+            return;
+        }
+
+        if (!push_wait(packet_q, std::move(pkt))) {
+            return;
+        }
+    }
+}
+
+void Pipeline::decode_thread() {
+    PooledPacketPtr pkt;
+    PooledFramePtr frame;
+    unsigned spins{};
+    DecodeQuality applied_quality{DecodeQuality::FULL};
+
+    const auto drain = [&] {
+        while (running.load(std::memory_order_acquire)) {
+            if (!frame) {
+                // Every shell is queued or being converted, wait for the conversion thread.
+                frame = decoded_pool.acquire();
+                if (!frame) {
+                    wait_backoff(spins);
+                    continue;
+                }
+
+                spins = 0;
+            }
+
+            if (!decoder.receive_frame(frame.get())) {
+                return;
+            }
+
+            decoded_pool.charge(frame);
+
+            if (!push_wait(decoded_q, std::move(frame))) {
+                return;
+            }
+        }
+    };
+
+    while (running.load(std::memory_order_acquire)) {
+        if (!packet_q.try_pop(pkt)) {
+            // Re-check after observing `demux_done`, the last packet may have landed in between.
+            if (demux_done.load(std::memory_order_acquire) && !packet_q.try_pop(pkt)) {
+                break;
+            }
+
+            if (!pkt) {
+                wait_backoff(spins);
+                continue;
+            }
+        }
+
+        spins = 0;
+
+        // Backpressure: no new frames while the budget is spent and some of it is ours to give
+        // back, otherwise a pipeline starting out behind a primed or stalled one never could.
+        while (MemoryBudget::exhausted() && (!decoded_q.empty() || !converted_q.empty()) &&
+               running.load(std::memory_order_acquire)) {
+            wait_backoff(spins);
+        }
+
+        spins = 0;
+
+        if (const auto q = quality.load(std::memory_order_acquire); q != applied_quality) {
+            decoder.set_quality(q);
+            applied_quality = q;
+        }
+
+        decoder.send_packet(pkt.get());
+        pkt.reset();
+
+        drain();
+    }
+
+    // Enter draining mode so the frames still buffered inside the codec are delivered.
+    decoder.send_packet(nullptr);
+    drain();
+}
+
+void Pipeline::convert_thread() {
+    PooledFramePtr frame;
+    unsigned spins{};
+
+    while (running.load(std::memory_order_acquire)) {
+        if (!frame && !decoded_q.try_pop(frame)) {
+            if (decode_done.load(std::memory_order_acquire) && !decoded_q.try_pop(frame)) {
+                return;
+            }
+
+            if (!frame) {
+                wait_backoff(spins);
+                continue;
+            }
+        }
+
+        // Keep hold of the source frame while the render thread still holds every pooled output.
+        auto out = decoder.convert_frame(frame.get());
+        if (!out) {
+            wait_backoff(spins);
+            continue;
+        }
+
+        spins = 0;
+        frame.reset();
+
+        if (!push_wait(converted_q, std::move(out))) {
+            return;
+        }
+    }
+}
+
+Pipeline::~Pipeline() {
+    if (running.load(std::memory_order_acquire)) {
+        const auto s = stats();
+        SPLAYER_LOG(INFO) << "Pipeline queue peaks (packets/decoded/converted): " << s.packets.peak
+                          << '/' << s.packets.capacity << ' ' << s.decoded.peak << '/'
+                          << s.decoded.capacity << ' ' << s.converted.peak << '/'
+                          << s.converted.capacity;
+    }
+
+    stop();
+}
+}  // namespace splayer
@@ -0,0 +1,114 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PIPELINE_H_
+#define PIPELINE_H_
+
+#include <splayer/codec/decode/decoder.h>
+#include <splayer/codec/decode/packet_pool.h>
+#include <splayer/util/spsc_queue.h>
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+#include "frame_source.h"
+
+namespace splayer {
+// Runs the demux, decode and conversion stages of a `Decoder` on their own threads, joined by
+// bounded SPSC queues. The render thread only pops converted frames.
+class Pipeline final : public FrameSource {
+public:
+    struct Depths {
+        std::size_t packets{64};
+        std::size_t decoded{4};
+        std::size_t converted{4};
+    };
+
+    struct QueueStats {
+        std::size_t depth;
+        std::size_t capacity;
+        std::size_t peak;
+    };
+
+    struct Stats {
+        QueueStats packets;
+        QueueStats decoded;
+        QueueStats converted;
+    };
+
+    Pipeline(Decoder &dec, Depths depths);
+    explicit Pipeline(Decoder &dec) : Pipeline(dec, Depths{}) {}
+    Pipeline(const Pipeline &) = delete;
+    Pipeline &operator=(const Pipeline &) = delete;
+    ~Pipeline() override;
+
+    void start();
+    void stop() noexcept;
+
+    PooledFramePtr pop_frame() override;
+    const AVFrame *peek_frame() override;
+    // True once every stage has drained and the last converted frame has been popped.
+    bool finished() const noexcept override;
+    bool failed() const noexcept { return failed_.load(std::memory_order_acquire); }
+    Stats stats() const noexcept;
+    // Handed to the decoder by the decode thread before its next packet, see
+    // `Decoder::set_quality`.
+    void set_quality(DecodeQuality q) noexcept { quality.store(q, std::memory_order_release); }
+
+private:
+    template <typename T>
+    static QueueStats queue_stats(const utils::SpscQueue<T> &q) noexcept {
+        return {q.size(), q.capacity(), q.peak_size()};
+    }
+
+    template <typename T>
+    bool push_wait(utils::SpscQueue<T> &q, T &&v);
+
+    void demux_thread();
+    void decode_thread();
+    void convert_thread();
+    void run_stage(void (Pipeline::*stage)(), std::atomic<bool> &done_flag) noexcept;
+
+    Decoder &decoder;
+
+    // Shells for decoded frames in flight between the decode and conversion threads, must outlive
+    // `decoded_q`.
+    FramePool decoded_pool;
+
+    // Shells for the packets queued between the demux and decode threads, must outlive `packet_q`
+    PacketPool packet_pool;
+
+    utils::SpscQueue<PooledPacketPtr> packet_q;
+    utils::SpscQueue<PooledFramePtr> decoded_q;
+    utils::SpscQueue<PooledFramePtr> converted_q;
+
+    std::atomic<bool> running{false};
+    std::atomic<bool> demux_done{false}, decode_done{false}, convert_done{false};
+    std::atomic<bool> failed_{false};
+    std::atomic<DecodeQuality> quality{DecodeQuality::FULL};
+
+    std::thread demux_th, decode_th, convert_th;
+};
+}  // namespace splayer
+
+#endif /* PIPELINE_H_ */
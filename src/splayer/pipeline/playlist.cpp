@@ -0,0 +1,191 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "playlist.h"
+
+#include <splayer/util/utils.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+using namespace utils;
+
+namespace splayer {
+Playlist::Playlist(std::vector<std::string> u, Opener o)
+    : urls(std::move(u)), opener(std::move(o)) {
+    cur = open_from(0);
+    if (!cur) {
+        Log(Log::ERROR) << "No playlist item could be opened.";
+        throw DecoderError(DecoderErrorDesc::FAILURE);
+    }
+}
+
+Playlist::~Playlist() {
+    // Waits for an item still being opened, which is then torn down with the future
+    if (next.valid()) {
+        next.wait();
+    }
+}
+
+std::unique_ptr<Playlist::Item> Playlist::open_from(std::size_t from) const {
+    for (std::size_t i = from; i < urls.size(); ++i) {
+        try {
+            auto item = std::make_unique<Item>();
+            item->index = i;
+            item->opened = opener(urls[i]);
+
+            const double fps = item->opened.decoder->clip_fps();
+            item->frame_duration = (fps > 0.0 ? std::llround(TIME_BASE.den / fps) : 0);
+            item->pipeline = std::make_unique<Pipeline>(*item->opened.decoder);
+            return item;
+        } catch (const DecoderError &e) {
+            Log(Log::ERROR) << "Skipping " << urls[i] << ": " << e.error_string();
+        } catch (const std::exception &e) {
+            Log(Log::ERROR) << "Skipping " << urls[i] << ": " << e.what();
+        }
+    }
+
+    return nullptr;
+}
+
+void Playlist::prefetch(std::size_t from) {
+    if (from >= urls.size()) {
+        return;
+    }
+
+    next = std::async(std::launch::async, [this, from] {
+        auto item = open_from(from);
+        // Primes the queues, the pipeline stalls once they're full until the item comes up
+        if (item) {
+            item->pipeline->start();
+        }
+
+        return item;
+    });
+}
+
+void Playlist::start() {
+    cur->pipeline->start();
+    prefetch(cur->index + 1);
+}
+
+bool Playlist::advance() {
+    if (!next.valid()) {
+        return false;
+    }
+
+    // Never blocks the caller, which keeps presenting the last frame until the item is open
+    if (next.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        if (!late) {
+            SPLAYER_LOG(VERBOSE) << "Waiting for the next playlist item to open";
+            late = true;
+            late_since = std::chrono::steady_clock::now();
+            stall_count += 1;
+        }
+
+        return false;
+    }
+
+    auto item = next.get();
+    if (!item) {
+        return false;
+    }
+
+    // Time spent waiting has passed on the presentation clock as well, push the item back by it
+    if (late) {
+        const auto waited = std::chrono::steady_clock::now() - late_since;
+        end_ts += std::chrono::duration_cast<std::chrono::microseconds>(waited).count();
+        late = false;
+    }
+
+    SPLAYER_LOG(INFO) << "Playing " << urls[item->index];
+
+    // The pipeline's threads and queues can go, the frames it handed out keep the decoder alive
+    cur->pipeline.reset();
+    retired.push_back(std::exchange(cur, std::move(item)));
+    switch_count += 1;
+    prefetch(cur->index + 1);
+
+    return true;
+}
+
+void Playlist::retime(AVFrame *f) {
+    auto ts = f->best_effort_timestamp;
+    if (ts == AV_NOPTS_VALUE) {
+        ts = f->pts;
+    }
+
+    if (ts == AV_NOPTS_VALUE) {
+        return;
+    }
+
+    ts = av_rescale_q(ts, cur->opened.decoder->clip_time_base(), TIME_BASE);
+    if (!cur->anchored) {
+        cur->offset = end_ts - ts;
+        cur->anchored = true;
+    }
+
+    ts += cur->offset;
+    f->pts = f->best_effort_timestamp = ts;
+    end_ts = std::max(end_ts, ts + cur->frame_duration);
+}
+
+void Playlist::release_retired() noexcept {
+    std::erase_if(retired,
+        [](const auto &item) { return item->opened.decoder->cnvt_frames_out() == 0; });
+}
+
+void Playlist::stage() {
+    release_retired();
+
+    if (staged) {
+        return;
+    }
+
+    staged = cur->pipeline->pop_frame();
+
+    // Checked after the pop, the last frame may have been converted in between
+    if (!staged && cur->pipeline->finished() && advance()) {
+        staged = cur->pipeline->pop_frame();
+    }
+
+    if (staged) {
+        retime(staged.get());
+    }
+}
+
+PooledFramePtr Playlist::pop_frame() {
+    stage();
+    return std::move(staged);
+}
+
+const AVFrame *Playlist::peek_frame() {
+    stage();
+    return staged.get();
+}
+
+bool Playlist::finished() const noexcept {
+    return !staged && !next.valid() && cur->pipeline->finished();
+}
+}  // namespace splayer
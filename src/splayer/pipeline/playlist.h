@@ -0,0 +1,125 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PLAYLIST_H_
+#define PLAYLIST_H_
+
+#include <splayer/codec/decode/decoder_factory.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "frame_source.h"
+#include "pipeline.h"
+
+namespace splayer {
+// Plays a list of inputs back to back as one stream of frames. While an item plays, the next one
+// is opened on a background thread and its pipeline started, so its first frames are converted
+// and waiting by the time the current item runs out.
+//
+// Timestamps are rewritten onto one continuous timeline in `TIME_BASE`: every item starts one
+// frame duration after the last frame of the one before it, so the switch lands exactly after the
+// last frame instead of re-anchoring the presentation clock.
+class Playlist final : public FrameSource {
+public:
+    // Runs on the background thread, has to configure the decoder for display before returning.
+    using Opener = std::function<OpenedDecoder(const std::string &url)>;
+
+    static constexpr AVRational TIME_BASE{1, 1000000};
+
+    // Opens the first item that opens, throwing if none does.
+    Playlist(std::vector<std::string> urls, Opener opener);
+    Playlist(const Playlist &) = delete;
+    Playlist &operator=(const Playlist &) = delete;
+    ~Playlist() override;
+
+    // Starts the current item and begins preparing the next one
+    void start();
+
+    PooledFramePtr pop_frame() override;
+    const AVFrame *peek_frame() override;
+    // True once the last item is finished, see `Pipeline::finished`
+    bool finished() const noexcept override;
+    // True once finished with the last item having failed, see `Pipeline::failed`
+    bool failed() const noexcept { return finished() && cur->pipeline->failed(); }
+
+    // The item currently playing, they change when `pop_frame`/`peek_frame` moves on to the next.
+    Decoder &decoder() noexcept { return *cur->opened.decoder; }
+    Pipeline &pipeline() noexcept { return *cur->pipeline; }
+    const DecoderChoice &decoder_choice() const noexcept { return cur->opened.choice; }
+    const std::string &url() const noexcept { return urls[cur->index]; }
+
+    // Items switched to and how many of those switches came late, with the current item done before
+    // the next one was open
+    std::size_t switches() const noexcept { return switch_count; }
+    std::size_t stalled_switches() const noexcept { return stall_count; }
+
+private:
+    struct Item {
+        std::size_t index{};
+        OpenedDecoder opened;
+        // Destroyed before the decoder it runs
+        std::unique_ptr<Pipeline> pipeline;
+        // Added to every timestamp once rescaled to `TIME_BASE`, known from the first frame
+        bool anchored{false};
+        std::int64_t offset{};
+        std::int64_t frame_duration{};
+    };
+
+    // Opens the first item from `from` on that opens, or returns null if none is left.
+    std::unique_ptr<Item> open_from(std::size_t from) const;
+    void prefetch(std::size_t from);
+    // Moves the next converted frame into `staged`, switching items when the current one is done.
+    void stage();
+    // Switches to the next item if it's open, returning false without waiting while it isn't.
+    bool advance();
+    void retime(AVFrame *f);
+    // Frees the retired items whose converted frames have all come back.
+    void release_retired() noexcept;
+
+    const std::vector<std::string> urls;
+    const Opener opener;
+
+    // Items switched away from. Their decoders own the pools of converted frames a consumer may
+    // still hold, so they're only freed once those are back. Declared first to go last.
+    std::vector<std::unique_ptr<Item>> retired;
+    std::unique_ptr<Item> cur;
+    std::future<std::unique_ptr<Item>> next;
+    PooledFramePtr staged;
+
+    // One frame duration past the last frame handed out, on the playlist timeline
+    std::int64_t end_ts{};
+    std::size_t switch_count{};
+    std::size_t stall_count{};
+    // Set while the current item is done but the next one is still opening
+    bool late{false};
+    std::chrono::steady_clock::time_point late_since;
+};
+}  // namespace splayer
+
+#endif /* PLAYLIST_H_ */
@@ -0,0 +1,204 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "stream_pool.h"
+
+#include <splayer/util/memory_budget.h>
+#include <splayer/util/utils.h>
+
+#include <algorithm>
+
+using namespace utils;
+
+namespace splayer {
+PooledFramePtr StreamPool::Stream::pop_frame() {
+    PooledFramePtr f;
+    if (queue.try_pop(f)) {
+        pool.frame_taken();
+    }
+
+    return f;
+}
+
+const AVFrame *StreamPool::Stream::peek_frame() {
+    const auto *f = queue.front();
+    return (f != nullptr ? f->get() : nullptr);
+}
+
+bool StreamPool::Stream::finished() const {
+    const std::lock_guard lk(pool.mtx);
+    return done && queue.empty();
+}
+
+bool StreamPool::Stream::failed() const {
+    const std::lock_guard lk(pool.mtx);
+    return error;
+}
+
+std::uint64_t StreamPool::Stream::frames_decoded() const {
+    const std::lock_guard lk(pool.mtx);
+    return decoded;
+}
+
+StreamPool::StreamPool(Config c) : cfg(c) {
+    if (cfg.workers == 0) {
+        cfg.workers = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+
+    cfg.stream_depth = std::max<std::size_t>(cfg.stream_depth, 1);
+}
+
+StreamPool::Stream &StreamPool::add_stream(Decoder &dec) {
+    const std::lock_guard lk(mtx);
+    streams.push_back(std::unique_ptr<Stream>(new Stream(*this, dec, cfg.stream_depth)));
+    return *streams.back();
+}
+
+void StreamPool::start() {
+    {
+        const std::lock_guard lk(mtx);
+        if (!threads.empty()) {
+            return;
+        }
+
+        max_in_flight = (cfg.max_in_flight ? cfg.max_in_flight : cfg.workers + streams.size());
+        stopping = false;
+    }
+
+    // More workers than streams would only ever wait
+    const auto n = std::min(cfg.workers, std::max<std::size_t>(streams.size(), 1));
+    threads.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        threads.emplace_back([this] { worker_loop(); });
+    }
+}
+
+void StreamPool::stop() noexcept {
+    {
+        const std::lock_guard lk(mtx);
+        stopping = true;
+    }
+    work_cv.notify_all();
+
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    threads.clear();
+}
+
+StreamPool::Stats StreamPool::stats() const {
+    const std::lock_guard lk(mtx);
+    return {frames, peak_in_flight, max_in_flight};
+}
+
+void StreamPool::frame_taken() {
+    {
+        const std::lock_guard lk(mtx);
+        in_flight -= 1;
+    }
+    work_cv.notify_one();
+}
+
+StreamPool::Stream *StreamPool::pick() noexcept {
+    // The budget is only honoured while frames are in flight, their release is what frees it
+    if (in_flight >= max_in_flight || (in_flight > 0 && MemoryBudget::exhausted())) {
+        return nullptr;
+    }
+
+    Stream *best{nullptr};
+    std::size_t best_idx{};
+    std::size_t best_depth{};
+
+    // Starting at the rotating cursor makes the first of equally full streams a different one
+    // each time.
+    for (std::size_t k = 0; k < streams.size(); ++k) {
+        const auto idx = (next_stream + k) % streams.size();
+        auto *s = streams[idx].get();
+        const auto depth = s->queue.size();
+
+        if (s->claimed || s->done || depth >= s->queue.capacity()) {
+            continue;
+        }
+
+        if (!best || depth < best_depth) {
+            best = s;
+            best_idx = idx;
+            best_depth = depth;
+        }
+    }
+
+    if (best) {
+        next_stream = best_idx + 1;
+    }
+
+    return best;
+}
+
+void StreamPool::worker_loop() {
+    std::unique_lock lk(mtx);
+
+    while (true) {
+        Stream *s{nullptr};
+        work_cv.wait(lk, [&] { return stopping || (s = pick()) != nullptr; });
+        if (stopping) {
+            return;
+        }
+
+        s->claimed = true;
+        in_flight += 1;
+        peak_in_flight = std::max(peak_in_flight, in_flight);
+        lk.unlock();
+
+        PooledFramePtr f;
+        bool error{false};
+        try {
+            f = s->decoder.decode_frame();
+        } catch (const DecoderError &e) {
+            Log(Log::ERROR) << "Stream failed: " << e.error_string();
+            error = true;
+        } catch (const std::exception &e) {
+            Log(Log::ERROR) << "Stream failed: " << e.what();
+            error = true;
+        }
+
+        lk.lock();
+        s->claimed = false;
+
+        if (f) {
+            // Room was checked when claiming, and only the claim holder pushes
+            s->queue.try_push(std::move(f));
+            s->decoded += 1;
+            frames += 1;
+        } else {
+            s->done = true;
+            s->error = error;
+            in_flight -= 1;
+        }
+
+        // The stream is free for the next worker
+        work_cv.notify_one();
+    }
+}
+
+StreamPool::~StreamPool() { stop(); }
+}  // namespace splayer
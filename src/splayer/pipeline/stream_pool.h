@@ -0,0 +1,125 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef STREAM_POOL_H_
+#define STREAM_POOL_H_
+
+#include <splayer/codec/decode/decoder.h>
+#include <splayer/util/spsc_queue.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "frame_source.h"
+
+namespace splayer {
+// Decodes many streams on one bounded set of workers instead of a `Pipeline` per stream. A worker
+// claims a stream, runs `Decoder::decode_frame` for one frame and queues the result on that
+// stream. Each stream is claimed by at most one worker at a time, so its decoder still only sees
+// one thread at a time.
+//
+// Fairness: of the streams with room in their queue, the one with the fewest queued frames goes
+// first, ties rotate. A global cap on frames decoded but not yet taken by the renderer keeps the
+// memory in use bounded however many streams there are.
+class StreamPool final {
+public:
+    struct Config {
+        // 0 is one per core
+        std::size_t workers{0};
+        // Converted frames queued per stream
+        std::size_t stream_depth{3};
+        // Frames queued or being decoded over all streams, 0 is `workers` frames plus one per
+        // stream
+        std::size_t max_in_flight{0};
+    };
+
+    class Stream final : public FrameSource {
+    public:
+        PooledFramePtr pop_frame() override;
+        const AVFrame *peek_frame() override;
+
+        // True once the decoder hit the end of its input (or failed) and every frame was popped
+        bool finished() const override;
+        bool failed() const;
+        std::uint64_t frames_decoded() const;
+
+    private:
+        friend StreamPool;
+        Stream(StreamPool &p, Decoder &d, std::size_t depth) : pool(p), decoder(d), queue(depth) {}
+
+        StreamPool &pool;
+        Decoder &decoder;
+        // Pushed by whichever worker holds the claim, claims are handed over under the pool mutex
+        utils::SpscQueue<PooledFramePtr> queue;
+
+        // Guarded by the pool mutex
+        bool claimed{false};
+        bool done{false};
+        bool error{false};
+        std::uint64_t decoded{};
+    };
+
+    struct Stats {
+        std::uint64_t frames;
+        std::size_t peak_in_flight;
+        std::size_t max_in_flight;
+    };
+
+    explicit StreamPool(Config cfg);
+    StreamPool(const StreamPool &) = delete;
+    StreamPool &operator=(const StreamPool &) = delete;
+    ~StreamPool();
+
+    // Registers `dec`, which must outlive the pool, before `start`.
+    Stream &add_stream(Decoder &dec);
+    void start();
+    void stop() noexcept;
+
+    Stats stats() const;
+
+private:
+    void worker_loop();
+    Stream *pick() noexcept;
+    void frame_taken();
+
+    Config cfg;
+
+    mutable std::mutex mtx;
+    std::condition_variable work_cv;
+    std::vector<std::unique_ptr<Stream>> streams;
+    std::size_t next_stream{};
+    std::size_t in_flight{};
+    std::size_t peak_in_flight{};
+    std::size_t max_in_flight{};
+    std::uint64_t frames{};
+    bool stopping{false};
+
+    std::vector<std::thread> threads;
+};
+}  // namespace splayer
+
+#endif /* STREAM_POOL_H_ */
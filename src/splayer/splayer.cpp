@@ -24,22 +24,57 @@
 
 #include <GL/glew.h>
 #include <splayer/cfg.h>
-#include <splayer/codec/decode/sw_fallback.h>
+#include <splayer/codec/convert/yuv_rgb.h>
 #include <splayer/display/gl_texture.h>
+#include <splayer/display/rgb_renderer.h>
+#include <splayer/display/video_quad.h>
+#include <splayer/display/yuv_renderer.h>
+#include <splayer/pipeline/frame_scheduler.h>
+#include <splayer/pipeline/load_governor.h>
+#include <splayer/pipeline/pipeline.h>
+#include <splayer/pipeline/playlist.h>
 #include <splayer/util/log.h>
 #include <splayer/window/window.h>
 
-#include <chrono>
+#include <algorithm>
+#include <cmath>
 #include <cstring>
-#include <thread>
+#include <optional>
 
 using namespace utils;
 
 namespace splayer {
-constexpr auto WIDTH = 3840;
-constexpr auto HEIGHT = 2160;
+namespace {
+graphics::YuvPlanes yuv_planes_of(const AVFrame *f) noexcept {
+    graphics::YuvPlanes p;
 
-SplayerApp::SplayerApp(const std::string &f) {
+    for (std::size_t i = 0; i < p.data.size(); ++i) {
+        p.data[i] = f->data[i];
+        p.linesize[i] = f->linesize[i];
+    }
+
+    p.width = f->width;
+    p.height = f->height;
+    p.semi_planar = (f->format == AV_PIX_FMT_NV12);
+
+    p.standard = color_standard_of(f);
+    p.range = color_range_of(f);
+
+    return p;
+}
+
+void log_stream_stats(const char *what, const std::optional<graphics::PboRing::Stats> &st) {
+    if (!st || st->uploads == 0) {
+        return;
+    }
+
+    SPLAYER_LOG(INFO) << what << " uploads streamed " << st->uploads << ", waited on the GPU "
+                      << st->fence_waits << " times for "
+                      << static_cast<double>(st->fence_wait_ns) / 1e6 << " ms";
+}
+}  // namespace
+
+SplayerApp::SplayerApp(const std::vector<std::string> &urls, const AppOptions &opts) {
     os_window = std::make_unique<graphics::Window>();
 
     const auto pm_dims = os_window->get_primary_monitor_dims();
@@ -48,66 +83,237 @@ SplayerApp::SplayerApp(const std::string &f) {
 
     os_window->create_window(cfg::PROJECT_NAME, window_w, window_h);
 
-    sw_decoder = std::make_unique<splayer::SwDecoder>();
+    // Later items are opened on the playlist's own thread, long after `opts` is gone
+    playlist = std::make_unique<Playlist>(urls, [opts](const std::string &url) {
+        auto opened = open_decoder(url, opts.decoder, [&](Decoder &dec) {
+            dec.set_threading(opts.threading);
+            dec.set_probe_cache(opts.probe_cache);
+            dec.set_input_io(opts.input_io, opts.input_io_cfg);
+        });
+        opened.decoder->set_cnvt_target(CnvtTarget::YUV);
+        return opened;
+    });
+
+    load_governor = opts.load_governor;
+}
 
-    sw_decoder->open_input(f);
+const DecoderChoice &SplayerApp::decoder_choice() const noexcept {
+    return playlist->decoder_choice();
 }
 
 void SplayerApp::gui_loop() {
-    graphics::GlTexture tex{WIDTH, HEIGHT};
+    // Shared by every item, only regenerated when an item's frames differ in size
+    const auto [clip_w, clip_h] = playlist->decoder().clip_dims();
+    graphics::GlTexture tex{clip_w, clip_h};
+    graphics::VideoQuad quad;
+    graphics::RgbRenderer rgb_renderer;
+    graphics::YuvRenderer yuv_renderer;
+    tex.enable_streaming();
+    PooledFramePtr cur_frame;
+    FrameScheduler scheduler{*playlist, Playlist::TIME_BASE, playlist->decoder().clip_fps()};
+    LoadGovernor governor{playlist->pipeline()};
+
+    playlist->start();
+    bool ended{false};
 
     os_window->window_loop([&] {
-        auto decode_t_beg = std::chrono::steady_clock::now();
+        // Paced by the swap interval; the scheduler decides which frame is due for this refresh.
+        auto next = scheduler.next_frame();
+        if (load_governor) {
+            governor.retarget(playlist->pipeline());
+            governor.update(scheduler.stats());
+        }
 
-        const auto f = sw_decoder->decode_frame();
-        if (f == nullptr) {
-            return;
+        if (!next && !ended && playlist->finished()) {
+            ended = true;
+
+            // Nothing more is coming, a failure would otherwise just freeze on the last frame
+            if (playlist->failed()) {
+                Log(Log::ERROR) << "Playback of " << playlist->url() << " failed, closing.";
+                os_window->request_close();
+            } else {
+                SPLAYER_LOG(INFO) << "Playback finished.";
+            }
         }
 
-        auto decode_t_end = std::chrono::steady_clock::now();
-        const auto decode_time_taken_us = std::chrono::duration_cast<std::chrono::microseconds>(decode_t_end - decode_t_beg).count();
+        if (next) {
+            cur_frame = std::move(next);
 
-        double clip_fps_us = (1000.0 / sw_decoder->clip_fps()) * 1000.0;
+            if (FrameConverter::is_display_yuv(cur_frame->format)) {
+                yuv_renderer.upload(yuv_planes_of(cur_frame.get()));
+            } else {
+                // Follow mid-stream resolution changes.
+                if (tex.dimensions() != std::tuple{cur_frame->width, cur_frame->height}) {
+                    tex.regen_texture(cur_frame->width, cur_frame->height);
+                }
 
-        if (decode_time_taken_us < clip_fps_us) {
-            clip_fps_us -= decode_time_taken_us;
-            std::cout << clip_fps_us << '\n';
-            std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>(clip_fps_us)));
+                tex.upload(cur_frame->data[0], cur_frame->linesize[0]);
+            }
         }
 
+        if (cur_frame == nullptr) {
+            return;
+        }
+
+        const auto f = cur_frame.get();
+
         os_window->force_consistent_aspect_r(f->width, f->height);
 
         const auto window_dims = os_window->get_window_dims();
         window_w = std::get<0>(window_dims);
         window_h = std::get<1>(window_dims);
 
-        glEnable(GL_BLEND);
-        glEnable(GL_TEXTURE_2D);
+        glClearColor(0.0, 0.0, 0.0, 1.0);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        const auto scale =
+            graphics::VideoQuad::letterbox_scale(f->width, f->height, window_w, window_h);
+
+        const bool is_yuv = FrameConverter::is_display_yuv(f->format);
+        if (is_yuv) {
+            yuv_renderer.bind(scale);
+        } else {
+            rgb_renderer.bind(tex, scale);
+        }
+
+        quad.draw();
+
+        if (is_yuv) {
+            yuv_renderer.unbind();
+        } else {
+            rgb_renderer.unbind(tex);
+        }
+    });
+
+    const auto st = scheduler.stats();
+    SPLAYER_LOG(INFO) << "Frames presented " << st.presented << ", dropped " << st.dropped
+                      << ", repeated " << st.repeated << ", late " << st.late;
+
+    if (playlist->switches() > 0) {
+        SPLAYER_LOG(INFO) << "Playlist switched items " << playlist->switches() << " times, "
+                          << playlist->stalled_switches() << " waited for the next to open";
+    }
+
+    log_stream_stats("RGB texture", tex.stream_stats());
+    log_stream_stats("YUV plane", yuv_renderer.stream_stats());
+
+    if (load_governor) {
+        const auto gs = governor.stats();
+        SPLAYER_LOG(INFO) << "Decode quality lowered " << gs.degrades << " times, raised "
+                          << gs.recoveries << " times, ended at "
+                          << decode_quality_name(governor.level());
+    }
+}
+
+SplayerApp::~SplayerApp() {
+    playlist.reset();
+    os_window.reset();
+}
+
+VideoWallApp::VideoWallApp(const std::vector<std::string> &urls, const AppOptions &opts) {
+    os_window = std::make_unique<graphics::Window>();
+
+    const auto pm_dims = os_window->get_primary_monitor_dims();
+    window_w = std::get<0>(pm_dims) * cfg::INITIAL_WINDOW_SCALE_MULTI;
+    window_h = std::get<1>(pm_dims) * cfg::INITIAL_WINDOW_SCALE_MULTI;
+
+    os_window->create_window(cfg::PROJECT_NAME, window_w, window_h);
+
+    const int n = static_cast<int>(urls.size());
+    cols = std::max(static_cast<int>(std::ceil(std::sqrt(static_cast<double>(n)))), 1);
+    rows = std::max((n + cols - 1) / cols, 1);
+
+    // The pool is where the parallelism comes from, codecs get a single thread unless asked
+    auto threading = opts.threading;
+    if (threading.threads == 0) {
+        threading.threads = 1;
+    }
+
+    pool = std::make_unique<StreamPool>(opts.wall);
+
+    for (const auto &url : urls) {
+        auto dec = open_decoder(url, opts.decoder, [&](Decoder &d) {
+            d.set_threading(threading);
+            d.set_probe_cache(opts.probe_cache);
+            d.set_input_io(opts.input_io, opts.input_io_cfg);
+        }).decoder;
+
+        const auto [clip_w, clip_h] = dec->clip_dims();
+        const auto [w, h] =
+            FrameConverter::fit_size(clip_w, clip_h, window_w / cols, window_h / rows);
+        dec->set_cnvt_target(CnvtTarget::YUV);
+        dec->set_cnvt_size(w, h);
+
+        streams.push_back(&pool->add_stream(*dec));
+        decoders.push_back(std::move(dec));
+    }
+}
+
+void VideoWallApp::gui_loop() {
+    const auto n = streams.size();
+    graphics::VideoQuad quad;
+    std::vector<graphics::YuvRenderer> renderers(n);
+    std::vector<PooledFramePtr> cur_frames(n);
+
+    std::vector<FrameScheduler> schedulers;
+    schedulers.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        schedulers.emplace_back(
+            *streams[i], decoders[i]->clip_time_base(), decoders[i]->clip_fps());
+    }
+
+    pool->start();
+
+    os_window->window_loop([&] {
+        const auto [win_w, win_h] = os_window->get_window_dims();
 
         glClearColor(0.0, 0.0, 0.0, 1.0);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        tex.bind();
-        glTexSubImage2D(
-            GL_TEXTURE_2D, 0, 0, 0, WIDTH, HEIGHT, GL_RGB, GL_UNSIGNED_BYTE, f->data[0]);
-
-        glBegin(GL_QUADS);
-        glTexCoord2f(0, 0);
-        glVertex2i(0, 0);
-        glTexCoord2f(0, 1);
-        glVertex2i(0, window_h);
-        glTexCoord2f(1, 1);
-        glVertex2i(window_w, window_h);
-        glTexCoord2f(1, 0);
-        glVertex2i(window_w, 0);
-        glEnd();
-
-        tex.unbind();
-
-        glDisable(GL_TEXTURE_2D);
-        glDisable(GL_BLEND);
+        for (std::size_t i = 0; i < n; ++i) {
+            if (auto next = schedulers[i].next_frame()) {
+                cur_frames[i] = std::move(next);
+                renderers[i].upload(yuv_planes_of(cur_frames[i].get()));
+            }
+
+            // Finished streams keep showing their last frame
+            const auto *f = cur_frames[i].get();
+            if (f == nullptr) {
+                continue;
+            }
+
+            // Tiles fill the rows from the top, viewports count from the bottom
+            const int col = static_cast<int>(i) % cols;
+            const int row = static_cast<int>(i) / cols;
+            const int x0 = col * win_w / cols;
+            const int x1 = (col + 1) * win_w / cols;
+            const int y0 = win_h - (row + 1) * win_h / rows;
+            const int y1 = win_h - row * win_h / rows;
+
+            glViewport(x0, y0, x1 - x0, y1 - y0);
+            renderers[i].bind(
+                graphics::VideoQuad::letterbox_scale(f->width, f->height, x1 - x0, y1 - y0));
+            quad.draw();
+            renderers[i].unbind();
+        }
     });
+
+    pool->stop();
+
+    const auto st = pool->stats();
+    SPLAYER_LOG(INFO) << "Video wall decoded " << st.frames << " frames, peak in flight "
+                      << st.peak_in_flight << '/' << st.max_in_flight;
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto sst = schedulers[i].stats();
+        SPLAYER_LOG(INFO) << "Stream " << i << ": decoded " << streams[i]->frames_decoded()
+                          << ", presented " << sst.presented << ", dropped " << sst.dropped
+                          << ", late " << sst.late;
+    }
 }
 
-SplayerApp::~SplayerApp() { os_window.reset(); }
+VideoWallApp::~VideoWallApp() {
+    pool.reset();
+    decoders.clear();
+    os_window.reset();
+}
 }  // namespace splayer
\ No newline at end of file
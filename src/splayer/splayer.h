@@ -21,25 +21,70 @@
 // SOFTWARE.
 
 #include <memory>
+#include <string>
+#include <vector>
+
+#include <splayer/codec/decode/decoder_factory.h>
+#include <splayer/codec/io/input_io.h>
+#include <splayer/pipeline/stream_pool.h>
 
 namespace graphics {
 class Window;
 }
 
 namespace splayer {
-class SwDecoder;
+class Playlist;
 }
 
 namespace splayer {
+struct AppOptions {
+    // See `open_decoder`. AUTO, where playback used to always decode in software: the hardware
+    // path is only kept once it has produced a frame.
+    DecoderPreference decoder{DecoderPreference::AUTO};
+    // See `Decoder::set_threading`
+    DecodeThreading threading;
+    // Lower decode quality while playback can't keep up, see `LoadGovernor`
+    bool load_governor{true};
+    // See `Decoder::set_probe_cache`
+    bool probe_cache{false};
+    // See `Decoder::set_input_io`
+    InputIoMode input_io{InputIoMode::DEFAULT};
+    InputIoConfig input_io_cfg;
+    // Workers and frame budget shared by the streams of `VideoWallApp`
+    StreamPool::Config wall;
+};
+
+// Plays its inputs one after the other without a gap between them, see `Playlist`.
 class SplayerApp final {
 public:
-    SplayerApp(const std::string &);
+    SplayerApp(const std::vector<std::string> &urls, const AppOptions &opts = {});
     void gui_loop();
+    // Which decoding path `open_decoder` settled on for the current input, and why
+    const DecoderChoice &decoder_choice() const noexcept;
     ~SplayerApp();
 
 private:
     std::unique_ptr<graphics::Window> os_window;
-    std::unique_ptr<splayer::SwDecoder> sw_decoder;
+    std::unique_ptr<splayer::Playlist> playlist;
+    bool load_governor{};
+    int window_w{}, window_h{};
+};
+
+// Plays every input at once in a grid of tiles in one window. The decoders share one
+// `StreamPool`, convert straight to their tile's size and are composited in a single pass.
+class VideoWallApp final {
+public:
+    VideoWallApp(const std::vector<std::string> &urls, const AppOptions &opts = {});
+    void gui_loop();
+    ~VideoWallApp();
+
+private:
+    std::unique_ptr<graphics::Window> os_window;
+    std::vector<std::unique_ptr<splayer::Decoder>> decoders;
+    // Holds frames of the decoders' pools, so it goes first
+    std::unique_ptr<splayer::StreamPool> pool;
+    std::vector<splayer::StreamPool::Stream *> streams;
+    int cols{}, rows{};
     int window_w{}, window_h{};
 };
 }  // namespace splayer
\ No newline at end of file
@@ -0,0 +1,66 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "alloc_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<std::uint64_t> allocations{0};
+
+void *counted_alloc(std::size_t n) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (void *p = std::malloc(n != 0 ? n : 1)) {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+void *counted_aligned_alloc(std::size_t n, std::align_val_t al) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    const auto a = static_cast<std::size_t>(al);
+    // aligned_alloc wants the size to be a multiple of the alignment
+    if (void *p = std::aligned_alloc(a, (n + a - 1) / a * a + (n == 0 ? a : 0))) {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+}  // namespace
+
+namespace utils {
+std::uint64_t heap_allocations() noexcept { return allocations.load(std::memory_order_relaxed); }
+}  // namespace utils
+
+// Replacements of the global allocation functions, the array and nothrow forms of the standard
+// library forward to these.
+void *operator new(std::size_t n) { return counted_alloc(n); }
+void *operator new(std::size_t n, std::align_val_t al) { return counted_aligned_alloc(n, al); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
@@ -0,0 +1,41 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef ALLOC_COUNTER_H_
+#define ALLOC_COUNTER_H_
+
+#include <cstdint>
+
+namespace utils {
+// Calls the process made to the global `operator new` so far, from every thread. The replacement
+// allocation functions doing the counting live in alloc_counter.cpp, which is only built with
+// ENABLE_ALLOC_COUNTER; other builds keep the standard allocator and always read 0.
+#ifdef SPLAYER_ALLOC_COUNTER
+constexpr bool HEAP_ALLOCATIONS_COUNTED = true;
+std::uint64_t heap_allocations() noexcept;
+#else
+constexpr bool HEAP_ALLOCATIONS_COUNTED = false;
+inline std::uint64_t heap_allocations() noexcept { return 0; }
+#endif
+}  // namespace utils
+
+#endif /* ALLOC_COUNTER_H_ */
@@ -0,0 +1,225 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "log.h"
+
+#include <atomic>
+#include <charconv>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "mpsc_queue.h"
+
+namespace utils {
+namespace {
+constexpr std::size_t RING_CAPACITY = 1024;
+
+struct LogRecord {
+    Log::LogType type;
+    std::uint16_t len;
+    std::array<char, Log::MAX_RECORD> text;
+};
+
+std::ostream &log_stream(Log::LogType lt) noexcept {
+    return (lt == Log::ERROR ? std::cerr : std::cout);
+}
+
+class LogBackend final {
+public:
+    LogBackend() : ring(RING_CAPACITY), writer([this] { run(); }) {}
+
+    void submit(Log::LogType lt, std::string_view record) noexcept {
+        // Counted before `stopped` is read, so `shutdown` can wait out pushes that raced with it
+        pushing.fetch_add(1, std::memory_order_seq_cst);
+
+        // After shutdown (static destruction, atexit) there is no writer left, write in place
+        if (stopped.load(std::memory_order_seq_cst)) [[unlikely]] {
+            pushing.fetch_sub(1, std::memory_order_release);
+            log_stream(lt).write(record.data(), static_cast<std::streamsize>(record.size()));
+            return;
+        }
+
+        LogRecord rec;
+        rec.type = lt;
+        rec.len = static_cast<std::uint16_t>(record.size());
+        record.copy(rec.text.data(), record.size());
+
+        if (!ring.try_push(rec)) [[unlikely]] {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            pushing.fetch_sub(1, std::memory_order_release);
+            return;
+        }
+
+        submitted.fetch_add(1, std::memory_order_release);
+        pushing.fetch_sub(1, std::memory_order_release);
+        wake();
+    }
+
+    void flush() noexcept {
+        if (stopped.load(std::memory_order_acquire)) {
+            return;
+        }
+
+        const auto target = submitted.load(std::memory_order_acquire);
+        wake();
+
+        while (written.load(std::memory_order_acquire) < target) {
+            std::this_thread::yield();
+        }
+    }
+
+    // Drains the ring and joins the writer. Records submitted afterwards are written synchronously.
+    void shutdown() noexcept {
+        stopping.store(true, std::memory_order_release);
+        wake();
+
+        if (writer.joinable()) {
+            writer.join();
+        }
+
+        stopped.store(true, std::memory_order_seq_cst);
+
+        // Records pushed after the writer's last drain but before `stopped` was set are still in
+        // the ring. Nobody else pops anymore, so this thread drains it once those pushes are done.
+        while (pushing.load(std::memory_order_acquire) > 0) {
+            std::this_thread::yield();
+        }
+
+        drain();
+
+        if (dropped_total > 0) {
+            std::cerr << LOGGER_HEADER << ' ' << formatted_logtime() << " Error: " << dropped_total
+                      << " log records dropped in total\n";
+        }
+    }
+
+private:
+    void wake() noexcept {
+        wake_seq.fetch_add(1, std::memory_order_release);
+        wake_seq.notify_one();
+    }
+
+    void run() {
+        while (true) {
+            const auto seq = wake_seq.load(std::memory_order_acquire);
+            const bool stop = stopping.load(std::memory_order_acquire);
+
+            drain();
+
+            if (stop) {
+                break;
+            }
+
+            wake_seq.wait(seq, std::memory_order_acquire);
+        }
+    }
+
+    // Consumer side, the writer thread or `shutdown` once it has been joined
+    void drain() {
+        LogRecord rec;
+        std::uint64_t n = 0;
+
+        while (ring.try_pop(rec)) {
+            log_stream(rec.type).write(rec.text.data(), rec.len);
+            n += 1;
+        }
+
+        if (const auto d = dropped.exchange(0, std::memory_order_relaxed)) {
+            dropped_total += d;
+            std::cerr << LOGGER_HEADER << ' ' << formatted_logtime() << " Error: " << d
+                      << " log records dropped, ring full\n";
+        }
+
+        if (n > 0) {
+            std::cout.flush();
+            std::cerr.flush();
+            written.fetch_add(n, std::memory_order_release);
+        }
+    }
+
+    MpscQueue<LogRecord> ring;
+    std::atomic<std::uint32_t> wake_seq{0};
+    std::atomic<std::uint64_t> submitted{0};
+    std::atomic<std::uint64_t> written{0};
+    std::atomic<std::uint64_t> dropped{0};
+    // Only touched by whoever drains
+    std::uint64_t dropped_total{0};
+    std::atomic<std::uint32_t> pushing{0};
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> stopped{false};
+    std::thread writer;
+};
+
+LogBackend &backend() {
+    // Never destroyed, so objects logging from their destructors during static destruction still
+    // find it. The writer is drained and joined from an exit handler instead.
+    static LogBackend *b = [] {
+        auto *nb = new LogBackend();
+        std::atexit([] { backend().shutdown(); });
+        return nb;
+    }();
+
+    return *b;
+}
+}  // namespace
+
+void Log::append_signed(long long v) noexcept {
+    std::array<char, 24> tmp;
+    const auto r = std::to_chars(tmp.data(), tmp.data() + tmp.size(), v);
+    append({tmp.data(), static_cast<std::size_t>(r.ptr - tmp.data())});
+}
+
+void Log::append_unsigned(unsigned long long v) noexcept {
+    std::array<char, 24> tmp;
+    const auto r = std::to_chars(tmp.data(), tmp.data() + tmp.size(), v);
+    append({tmp.data(), static_cast<std::size_t>(r.ptr - tmp.data())});
+}
+
+void Log::append_double(double v) noexcept {
+    std::array<char, 32> tmp;
+    const auto r =
+        std::to_chars(tmp.data(), tmp.data() + tmp.size(), v, std::chars_format::general, 6);
+    append({tmp.data(), static_cast<std::size_t>(r.ptr - tmp.data())});
+}
+
+void Log::append_pointer(std::uintptr_t v) noexcept {
+    std::array<char, 24> tmp{'0', 'x'};
+    const auto r = std::to_chars(tmp.data() + 2, tmp.data() + tmp.size(), v, 16);
+    append({tmp.data(), static_cast<std::size_t>(r.ptr - tmp.data())});
+}
+
+void Log::append_streamed(void (*fmt)(std::ostream &, const void *), const void *v) noexcept {
+    try {
+        thread_local std::ostringstream oss;
+        oss.str({});
+        fmt(oss, v);
+        append(oss.view());
+    } catch (...) {
+    }
+}
+
+void Log::submit(LogType lt, std::string_view record) noexcept { backend().submit(lt, record); }
+
+void Log::flush() noexcept { backend().flush(); }
+}  // namespace utils
@@ -23,12 +23,26 @@
 #ifndef LOG_H_
 #define LOG_H_
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
-#include <iostream>
+#include <iosfwd>
+#include <string_view>
+#include <type_traits>
 
 #include "pf_wrapper.h"
 #include "str_utils.h"
 
+// 0: errors only, 1: and info, 2: and verbose. Records above the level compile to nothing when
+// written through `SPLAYER_LOG`.
+#ifndef SPLAYER_LOG_LEVEL
+#ifdef NDEBUG
+#define SPLAYER_LOG_LEVEL 1
+#else
+#define SPLAYER_LOG_LEVEL 2
+#endif
+#endif
+
 namespace utils {
 struct SourceLocation {
     constexpr SourceLocation(const char *f, const char *func, std::uint_least32_t l)
@@ -65,6 +79,8 @@ private:
     std::uint_least32_t line;
 };
 
+// Records are formatted into a buffer owned by the `Log` object without allocating, then handed to
+// a background writer through a lock-free ring so the calling thread never blocks on the console.
 class Log {
 public:
     enum class LogType : std::uint8_t { Info = 0, Error, Verbose };
@@ -72,33 +88,53 @@ public:
     static constexpr auto ERROR = LogType::Error;
     static constexpr auto VERBOSE = LogType::Verbose;
 
-    Log(LogType logtype = INFO, SourceLocation slc = SourceLocation::current())
-        : out_log(log_stream(logtype)) {
-        out_log << LOGGER_HEADER << ' ' << formatted_logtime() << " [" << slc.get_filename() << ':'
-                << slc.get_line() << "] " << get_logtype_str(logtype) << ": ";
+    // Longer records are truncated
+    static constexpr std::size_t MAX_RECORD = 480;
+
+    Log(LogType logtype = INFO, SourceLocation slc = SourceLocation::current()) noexcept
+        : type(logtype), active(enabled(logtype)) {
+        if (active) {
+            *this << LOGGER_HEADER << ' ' << formatted_logtime() << " [" << slc.get_filename()
+                  << ':' << slc.get_line() << "] " << get_logtype_str(logtype) << ": ";
+        }
+    }
+
+    ~Log() {
+        if (active) {
+            buf[len++] = '\n';
+            submit(type, {buf.data(), len});
+        }
     }
 
-    ~Log() { out_log << '\n'; }
+    Log(const Log &) = delete;
+    Log &operator=(const Log &) = delete;
+
     template <typename T>
-    std::ostream &operator<<(const T &msg) noexcept {
-        out_log << msg;
-        return out_log;
+    Log &operator<<(const T &msg) noexcept {
+        if (active) {
+            append_value(msg);
+        }
+        return *this;
     }
 
-private:
-    std::ostream &log_stream(LogType lt) const noexcept {
+    // Blocks until every record submitted so far has been written out.
+    static void flush() noexcept;
+
+    static constexpr bool enabled(LogType lt) noexcept {
         switch (lt) {
+            case LogType::Error:
+                return true;
             case LogType::Info:
+                return SPLAYER_LOG_LEVEL >= 1;
             case LogType::Verbose:
-                return std::cout;
-            case LogType::Error:
-                return std::cerr;
+                return SPLAYER_LOG_LEVEL >= 2;
         }
 
-        return std::cout;
+        return true;
     }
 
-    constexpr std::string_view get_logtype_str(LogType lt) const noexcept {
+private:
+    static constexpr std::string_view get_logtype_str(LogType lt) noexcept {
         switch (lt) {
             case LogType::Info:
                 return "Info";
@@ -111,9 +147,60 @@ private:
         return "Info";
     }
 
-    std::ostream &out_log;
+    static void submit(LogType lt, std::string_view record) noexcept;
+
+    void append(std::string_view s) noexcept {
+        // Keeps one byte for the trailing newline
+        const auto n = std::min(s.size(), MAX_RECORD - 1 - len);
+        s.copy(buf.data() + len, n);
+        len += n;
+    }
+
+    template <typename T>
+    void append_value(const T &v) noexcept {
+        if constexpr (std::is_same_v<T, bool>) {
+            append(v ? "1" : "0");
+        } else if constexpr (std::is_same_v<T, char>) {
+            append({&v, 1});
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            append_signed(v);
+        } else if constexpr (std::is_integral_v<T>) {
+            append_unsigned(v);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            append_double(static_cast<double>(v));
+        } else if constexpr (std::is_enum_v<T>) {
+            append_value(static_cast<std::underlying_type_t<T>>(v));
+        } else if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+            append(std::string_view(v));
+        } else if constexpr (std::is_pointer_v<T>) {
+            append_pointer(reinterpret_cast<std::uintptr_t>(v));
+        } else {
+            append_streamed(
+                [](std::ostream &os, const void *p) { os << *static_cast<const T *>(p); }, &v);
+        }
+    }
+
+    // Kept out of line so the header doesn't pull <charconv> and <sstream> into every file
+    void append_signed(long long v) noexcept;
+    void append_unsigned(unsigned long long v) noexcept;
+    void append_double(double v) noexcept;
+    void append_pointer(std::uintptr_t v) noexcept;
+    // Fallback for types that only provide an ostream operator, may allocate.
+    void append_streamed(void (*fmt)(std::ostream &, const void *), const void *v) noexcept;
+
+    std::array<char, MAX_RECORD> buf;
+    std::size_t len{};
+    const LogType type;
+    const bool active;
 };
 
 }  // namespace utils
 
+// Records through `Log` directly still evaluate their operands when the level is compiled out,
+// this checks the level first: `SPLAYER_LOG(VERBOSE) << expensive()` costs nothing in release.
+#define SPLAYER_LOG(level)                                   \
+    if (!::utils::Log::enabled(::utils::Log::level)) {       \
+    } else                                                   \
+        ::utils::Log(::utils::Log::level)
+
 #endif /* LOG_H_ */
\ No newline at end of file
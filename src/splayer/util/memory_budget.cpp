@@ -0,0 +1,116 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "memory_budget.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace utils {
+namespace {
+// Holders of every shared buffer currently charged. Only the buffers of frames in flight are in
+// here, few enough for a linear search, and the reserve keeps the steady state off the heap.
+class SharedLedger final {
+public:
+    struct Entry {
+        const void *buffer;
+        std::size_t bytes;
+        std::size_t holders;
+    };
+
+    SharedLedger() { entries.reserve(RESERVED_ENTRIES); }
+
+    // Returns the bytes to charge, 0 if the buffer was already
+    std::size_t add(const void *buffer, std::size_t bytes) {
+        const std::lock_guard lk(mtx);
+
+        const auto it = find(buffer);
+        if (it != entries.end()) {
+            it->holders += 1;
+            return 0;
+        }
+
+        entries.push_back({buffer, bytes, 1});
+        return bytes;
+    }
+
+    // Returns the bytes to release, 0 while the buffer has other holders
+    std::size_t remove(const void *buffer) noexcept {
+        const std::lock_guard lk(mtx);
+
+        const auto it = find(buffer);
+        if (it == entries.end() || --it->holders > 0) {
+            return 0;
+        }
+
+        const auto bytes = it->bytes;
+        *it = entries.back();
+        entries.pop_back();
+        return bytes;
+    }
+
+private:
+    static constexpr std::size_t RESERVED_ENTRIES = 1024;
+
+    std::vector<Entry>::iterator find(const void *buffer) noexcept {
+        return std::find_if(entries.begin(), entries.end(),
+            [buffer](const Entry &e) { return e.buffer == buffer; });
+    }
+
+    std::mutex mtx;
+    std::vector<Entry> entries;
+};
+
+SharedLedger &shared_ledger() {
+    static SharedLedger ledger;
+    return ledger;
+}
+}  // namespace
+
+void MemoryBudget::charge(std::size_t bytes) noexcept {
+    const auto used = used_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+    auto peak = peak_bytes.load(std::memory_order_relaxed);
+    while (used > peak &&
+           !peak_bytes.compare_exchange_weak(peak, used, std::memory_order_relaxed)) {
+    }
+}
+
+void MemoryBudget::charge_shared(const void *buffer, std::size_t bytes) noexcept {
+    try {
+        charge(shared_ledger().add(buffer, bytes));
+    } catch (...) {
+        // Left uncharged, `release_shared` won't find it either
+    }
+}
+
+void MemoryBudget::release_shared(const void *buffer) noexcept {
+    release(shared_ledger().remove(buffer));
+}
+
+MemoryBudget::Usage MemoryBudget::usage() noexcept {
+    return {used_bytes.load(std::memory_order_relaxed),
+            peak_bytes.load(std::memory_order_relaxed),
+            limit_bytes.load(std::memory_order_relaxed)};
+}
+}  // namespace utils
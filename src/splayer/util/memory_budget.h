@@ -0,0 +1,73 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef MEMORY_BUDGET_H_
+#define MEMORY_BUDGET_H_
+
+#include <atomic>
+#include <cstddef>
+
+namespace utils {
+// Process-wide account of the memory held by frames in flight: decoded frames waiting to be
+// converted, converted frames queued for display and the frames the renderer still holds for
+// upload. Charging never fails, the producers at the head of the decode path instead check
+// `exhausted` and hold off until consumers have released enough. Usage can thus overshoot the
+// limit by the frames already on their way.
+class MemoryBudget final {
+public:
+    struct Usage {
+        std::size_t used;
+        std::size_t peak;
+        // 0 when unlimited
+        std::size_t limit;
+    };
+
+    // 0 removes the limit
+    static void set_limit(std::size_t bytes) noexcept {
+        limit_bytes.store(bytes, std::memory_order_relaxed);
+    }
+
+    static void charge(std::size_t bytes) noexcept;
+    static void release(std::size_t bytes) noexcept {
+        used_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    // For a buffer several frames may reference at once, e.g. a decoded frame and the converted
+    // frame passing it through. Only its first holder charges `bytes`, its last releases them.
+    static void charge_shared(const void *buffer, std::size_t bytes) noexcept;
+    static void release_shared(const void *buffer) noexcept;
+
+    static bool exhausted() noexcept {
+        const auto limit = limit_bytes.load(std::memory_order_relaxed);
+        return limit > 0 && used_bytes.load(std::memory_order_relaxed) >= limit;
+    }
+
+    static Usage usage() noexcept;
+
+private:
+    static inline std::atomic<std::size_t> used_bytes{0};
+    static inline std::atomic<std::size_t> peak_bytes{0};
+    static inline std::atomic<std::size_t> limit_bytes{0};
+};
+}  // namespace utils
+
+#endif /* MEMORY_BUDGET_H_ */
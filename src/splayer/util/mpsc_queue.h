@@ -0,0 +1,106 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef MPSC_QUEUE_H_
+#define MPSC_QUEUE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace utils {
+// Bounded lock-free multi-producer/single-consumer ring. Any number of threads may push, exactly
+// one thread may pop. Each slot carries a sequence number, so producers only contend on the tail
+// index and never wait on each other to finish writing.
+template <typename T>
+class MpscQueue final {
+public:
+    using size_type = std::size_t;
+
+    explicit MpscQueue(size_type capacity)
+        : cells(std::make_unique<Cell[]>(std::bit_ceil(std::max(capacity, size_type{2})))),
+          mask(std::bit_ceil(std::max(capacity, size_type{2})) - 1) {
+        for (size_type i = 0; i <= mask; ++i) {
+            cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    // Producer side, returns false when the ring is full.
+    bool try_push(const T &v) {
+        auto pos = tail.load(std::memory_order_relaxed);
+
+        while (true) {
+            auto &c = cells[pos & mask];
+            const auto seq = c.seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.value = v;
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Consumer side
+    bool try_pop(T &out) {
+        auto &c = cells[head & mask];
+        if (c.seq.load(std::memory_order_acquire) != head + 1) {
+            return false;
+        }
+
+        out = std::move(c.value);
+        c.seq.store(head + mask + 1, std::memory_order_release);
+        head += 1;
+        return true;
+    }
+
+    size_type capacity() const noexcept { return mask + 1; }
+
+private:
+    static constexpr size_type CACHE_LINE = 64;
+
+    struct Cell {
+        std::atomic<size_type> seq;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    const size_type mask;
+
+    alignas(CACHE_LINE) std::atomic<size_type> tail{0};
+    alignas(CACHE_LINE) size_type head{0};
+};
+}  // namespace utils
+
+#endif /* MPSC_QUEUE_H_ */
@@ -23,6 +23,14 @@
 #include "pf_wrapper.h"
 
 #include <ctime>
+#include <fstream>
+#include <string>
+
+#ifdef LIN
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
 
 #include "utils.h"
 
@@ -47,19 +55,101 @@ long gettime_seconds() {
 #endif
 }
 
-std::string formatted_logtime() {
+std::string_view formatted_logtime() {
 #ifdef LIN
-    std::tm tbuf, *now;
-    time_t t;
-    char strbuf[16];
+    thread_local time_t cached_t = -1;
+    thread_local char strbuf[16];
 
-    t = std::time(nullptr);
-    now = localtime_r(&t, &tbuf);
-    std::strftime(strbuf, sizeof(strbuf), "%H:%M:%S", now);
+    const time_t t = std::time(nullptr);
+    if (t != cached_t) {
+        std::tm tbuf;
+        std::strftime(strbuf, sizeof(strbuf), "%H:%M:%S", localtime_r(&t, &tbuf));
+        cached_t = t;
+    }
 
     return strbuf;
 #else
     return {};
 #endif
 }
+
+std::int64_t process_cputime_ns() {
+#ifdef LIN
+    struct timespec tp;
+    VERIF0(clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &tp));
+    return (tp.tv_sec * 1000000000L) + tp.tv_nsec;
+#else
+    return {};
+#endif
+}
+
+std::int64_t peak_rss_bytes() {
+#ifdef LIN
+    struct rusage ru;
+    VERIF0(getrusage(RUSAGE_SELF, &ru));
+    // Linux reports kilobytes
+    return ru.ru_maxrss * 1024L;
+#else
+    return {};
+#endif
+}
+
+std::int64_t current_rss_bytes() {
+#ifdef LIN
+    // Second field, in pages
+    std::ifstream statm("/proc/self/statm");
+    std::int64_t size{}, resident{};
+    if (!(statm >> size >> resident)) {
+        return {};
+    }
+
+    return resident * sysconf(_SC_PAGESIZE);
+#else
+    return {};
+#endif
+}
+
+IoCounters process_io_counters() {
+    IoCounters c{};
+#ifdef LIN
+    std::ifstream io("/proc/self/io");
+    std::string key;
+    std::int64_t value{};
+    while (io >> key >> value) {
+        if (key == "syscr:") {
+            c.read_syscalls = value;
+        } else if (key == "rchar:") {
+            c.read_bytes = value;
+        }
+    }
+
+    struct rusage ru;
+    VERIF0(getrusage(RUSAGE_SELF, &ru));
+    c.minor_faults = ru.ru_minflt;
+    c.major_faults = ru.ru_majflt;
+#endif
+    return c;
+}
+
+void UniqueFd::reset(int f) noexcept {
+#ifdef LIN
+    if (fd >= 0) {
+        close(fd);
+    }
+#endif
+    fd = f;
+}
+
+bool evict_file_cache([[maybe_unused]] const std::string &path) {
+#ifdef LIN
+    const UniqueFd fd(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (!fd) {
+        return false;
+    }
+
+    return (posix_fadvise(fd.get(), 0, 0, POSIX_FADV_DONTNEED) == 0);
+#else
+    return false;
+#endif
+}
 }  // namespace utils
\ No newline at end of file
@@ -23,12 +23,59 @@
 #ifndef PF_WRAPPER_H_
 #define PF_WRAPPER_H_
 
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <utility>
 
 namespace utils {
 long gettime_highres();
 long gettime_seconds();
-std::string formatted_logtime();
+// Wall clock "HH:MM:SS", reformatted at most once per second per thread. Valid until the calling
+// thread's next call.
+std::string_view formatted_logtime();
+// User + system CPU time consumed by the process so far.
+std::int64_t process_cputime_ns();
+// Peak resident set size of the process.
+std::int64_t peak_rss_bytes();
+// Resident set size of the process right now.
+std::int64_t current_rss_bytes();
+
+struct IoCounters {
+    // read(2)-like syscalls made by the process and the bytes they returned
+    std::int64_t read_syscalls;
+    std::int64_t read_bytes;
+    std::int64_t minor_faults;
+    std::int64_t major_faults;
+};
+
+// Totals for the whole process since it started, zero where the platform doesn't report them.
+IoCounters process_io_counters();
+
+// Owns a file descriptor and closes it on destruction, -1 when empty.
+class UniqueFd {
+public:
+    UniqueFd() = default;
+    explicit UniqueFd(int f) noexcept : fd(f) {}
+    UniqueFd(UniqueFd &&o) noexcept : fd(std::exchange(o.fd, -1)) {}
+    UniqueFd &operator=(UniqueFd &&o) noexcept {
+        if (this != &o) {
+            reset(std::exchange(o.fd, -1));
+        }
+        return *this;
+    }
+    ~UniqueFd() { reset(); }
+
+    int get() const noexcept { return fd; }
+    explicit operator bool() const noexcept { return fd >= 0; }
+    void reset(int f = -1) noexcept;
+
+private:
+    int fd{-1};
+};
+
+// Drops the clean cached pages of a file, so the next read of it has to go to the disk.
+bool evict_file_cache(const std::string &path);
 }  // namespace utils
 
 #endif /* PF_WRAPPER_H_ */
\ No newline at end of file
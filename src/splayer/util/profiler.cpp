@@ -0,0 +1,280 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <mutex>
+
+#include "utils.h"
+
+namespace utils {
+namespace {
+constexpr std::size_t ZONE_COUNT = static_cast<std::size_t>(ProfZone::COUNT);
+constexpr std::size_t BUCKET_COUNT = 64;
+constexpr std::size_t TRACE_CAPACITY = 1 << 16;
+
+constexpr std::array<std::string_view, ZONE_COUNT> zone_names = {"av_read_frame",
+    "avcodec_send_packet", "avcodec_receive_frame", "av_hwframe_transfer_data", "sws_scale",
+    "yuv_to_rgb", "texture_upload", "glfwSwapBuffers"};
+
+// Only the owning thread writes, so a relaxed load + store is enough and avoids a locked RMW.
+void single_writer_add(std::atomic<std::uint64_t> &a, std::uint64_t v) noexcept {
+    a.store(a.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+}
+
+struct Histogram {
+    // Bucket b holds durations in [2^(b-1), 2^b) ns
+    std::array<std::atomic<std::uint64_t>, BUCKET_COUNT> buckets{};
+    std::atomic<std::uint64_t> count{};
+    std::atomic<std::uint64_t> total_ns{};
+    std::atomic<std::uint64_t> max_ns{};
+
+    void add(std::uint64_t ns) noexcept {
+        const auto b = std::min<std::size_t>(std::bit_width(ns), BUCKET_COUNT - 1);
+        single_writer_add(buckets[b], 1);
+        single_writer_add(count, 1);
+        single_writer_add(total_ns, ns);
+
+        if (ns > max_ns.load(std::memory_order_relaxed)) {
+            max_ns.store(ns, std::memory_order_relaxed);
+        }
+    }
+};
+
+struct TraceEvent {
+    long beg_ns;
+    long dur_ns;
+    ProfZone zone;
+};
+
+struct ThreadProfile {
+    explicit ThreadProfile(std::uint32_t id, bool trace) : tid(id) {
+        if (trace) {
+            events = std::make_unique<TraceEvent[]>(TRACE_CAPACITY);
+        }
+    }
+
+    void add_event(ProfZone z, long beg_ns, long dur_ns) noexcept {
+        const auto n = n_events.load(std::memory_order_relaxed);
+        if (n == TRACE_CAPACITY) {
+            single_writer_add(dropped_events, 1);
+            return;
+        }
+
+        events[n] = {beg_ns, dur_ns, z};
+        // Publishes the event to `write_trace`
+        n_events.store(n + 1, std::memory_order_release);
+    }
+
+    const std::uint32_t tid;
+    std::array<Histogram, ZONE_COUNT> zones;
+    std::unique_ptr<TraceEvent[]> events;
+    std::atomic<std::size_t> n_events{};
+    std::atomic<std::uint64_t> dropped_events{};
+};
+
+// Thread profiles are owned here rather than by the thread, so results survive thread exit.
+struct Registry {
+    std::mutex mtx;
+    std::vector<std::unique_ptr<ThreadProfile>> threads;
+    // Profiles of exited threads, handed to the next threads that start recording
+    std::vector<ThreadProfile *> idle;
+    std::atomic<bool> trace{false};
+};
+
+Registry &registry() {
+    static Registry reg;
+    return reg;
+}
+
+// A thread's claim on a profile. It goes back to the registry when the thread exits, so threads
+// started per playlist item keep adding to the same few histograms instead of growing the
+// registry by one profile each. A reused profile also keeps its trace `tid`.
+struct LocalProfile {
+    LocalProfile() = default;
+    LocalProfile(const LocalProfile &) = delete;
+    LocalProfile &operator=(const LocalProfile &) = delete;
+
+    ~LocalProfile() {
+        if (profile) {
+            auto &reg = registry();
+            const std::lock_guard lk(reg.mtx);
+            reg.idle.push_back(profile);
+        }
+    }
+
+    ThreadProfile *profile{nullptr};
+};
+
+ThreadProfile &local_profile() {
+    thread_local LocalProfile local;
+
+    if (!local.profile) [[unlikely]] {
+        auto &reg = registry();
+        const std::lock_guard lk(reg.mtx);
+        const bool trace = reg.trace.load(std::memory_order_relaxed);
+
+        if (!reg.idle.empty()) {
+            local.profile = reg.idle.back();
+            reg.idle.pop_back();
+
+            if (trace && !local.profile->events) {
+                local.profile->events = std::make_unique<TraceEvent[]>(TRACE_CAPACITY);
+            }
+        } else {
+            const auto id = static_cast<std::uint32_t>(reg.threads.size());
+            reg.threads.push_back(std::make_unique<ThreadProfile>(id, trace));
+            local.profile = reg.threads.back().get();
+        }
+    }
+
+    return *local.profile;
+}
+
+double ns_to_us(std::uint64_t ns) noexcept { return static_cast<double>(ns) / 1000.0; }
+}  // namespace
+
+void Profiler::enable(bool trace) noexcept {
+    registry().trace.store(trace, std::memory_order_relaxed);
+    enabled_flag.store(true, std::memory_order_relaxed);
+}
+
+void Profiler::disable() noexcept { enabled_flag.store(false, std::memory_order_relaxed); }
+
+void Profiler::record(ProfZone z, long beg_ns, long end_ns) noexcept {
+    auto &tp = local_profile();
+    const auto dur_ns = std::max(0L, end_ns - beg_ns);
+
+    tp.zones[static_cast<std::size_t>(z)].add(static_cast<std::uint64_t>(dur_ns));
+
+    if (tp.events) {
+        tp.add_event(z, beg_ns, dur_ns);
+    }
+}
+
+std::string_view Profiler::zone_name(ProfZone z) noexcept {
+    return zone_names[static_cast<std::size_t>(z)];
+}
+
+std::vector<Profiler::ZoneSummary> Profiler::summarize() {
+    auto &reg = registry();
+    const std::lock_guard lk(reg.mtx);
+
+    std::vector<ZoneSummary> out;
+
+    for (std::size_t z = 0; z < ZONE_COUNT; ++z) {
+        std::array<std::uint64_t, BUCKET_COUNT> buckets{};
+        std::uint64_t count{}, total_ns{}, max_ns{};
+
+        for (const auto &tp : reg.threads) {
+            const auto &h = tp->zones[z];
+            for (std::size_t b = 0; b < BUCKET_COUNT; ++b) {
+                buckets[b] += h.buckets[b].load(std::memory_order_relaxed);
+            }
+            count += h.count.load(std::memory_order_relaxed);
+            total_ns += h.total_ns.load(std::memory_order_relaxed);
+            max_ns = std::max(max_ns, h.max_ns.load(std::memory_order_relaxed));
+        }
+
+        if (count == 0) {
+            continue;
+        }
+
+        const auto percentile = [&](double q) {
+            const auto target = static_cast<std::uint64_t>(q * static_cast<double>(count));
+            std::uint64_t seen{};
+            for (std::size_t b = 0; b < BUCKET_COUNT; ++b) {
+                seen += buckets[b];
+                if (seen > target) {
+                    return ns_to_us(std::min(max_ns, (std::uint64_t{1} << b) - 1));
+                }
+            }
+            return ns_to_us(max_ns);
+        };
+
+        out.push_back({zone_names[z], count, ns_to_us(total_ns) / static_cast<double>(count),
+            percentile(0.50), percentile(0.99), ns_to_us(max_ns)});
+    }
+
+    return out;
+}
+
+void Profiler::log_summary() {
+    for (const auto &s : summarize()) {
+        SPLAYER_LOG(INFO) << s.name << ": n=" << s.count << " mean=" << s.mean_us
+                          << "us p50<=" << s.p50_us << "us p99<=" << s.p99_us
+                          << "us max=" << s.max_us << "us";
+    }
+}
+
+bool Profiler::write_trace(const std::string &path) {
+    std::ofstream os(path);
+    if (!os) {
+        return false;
+    }
+
+    auto &reg = registry();
+    const std::lock_guard lk(reg.mtx);
+
+    long origin_ns = std::numeric_limits<long>::max();
+    for (const auto &tp : reg.threads) {
+        const auto n = (tp->events ? tp->n_events.load(std::memory_order_acquire) : 0);
+        for (std::size_t i = 0; i < n; ++i) {
+            origin_ns = std::min(origin_ns, tp->events[i].beg_ns);
+        }
+    }
+
+    os << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+
+    bool first = true;
+    for (const auto &tp : reg.threads) {
+        if (!tp->events) {
+            continue;
+        }
+
+        const auto n = tp->n_events.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto &e = tp->events[i];
+            os << (first ? "\n" : ",\n") << "{\"name\":\"" << zone_name(e.zone)
+               << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tp->tid
+               << ",\"ts\":" << static_cast<double>(e.beg_ns - origin_ns) / 1000.0
+               << ",\"dur\":" << static_cast<double>(e.dur_ns) / 1000.0 << '}';
+            first = false;
+        }
+
+        if (const auto dropped = tp->dropped_events.load(std::memory_order_relaxed)) {
+            Log(Log::ERROR) << "Trace buffer of thread " << tp->tid << " dropped " << dropped
+                            << " events";
+        }
+    }
+
+    os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return static_cast<bool>(os);
+}
+}  // namespace utils
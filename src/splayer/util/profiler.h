@@ -0,0 +1,117 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "pf_wrapper.h"
+
+namespace utils {
+enum class ProfZone : std::uint8_t {
+    READ_FRAME = 0,
+    SEND_PACKET,
+    RECEIVE_FRAME,
+    HWFRAME_TRANSFER,
+    SWS_SCALE,
+    YUV_TO_RGB,
+    TEXTURE_UPLOAD,
+    SWAP_BUFFERS,
+    COUNT
+};
+
+// Process-wide hot path profiler. Every thread records into its own log2 histograms (and
+// optionally a trace event buffer) without locks; readers merge them on demand. While disabled, a
+// zone costs a single relaxed load.
+class Profiler final {
+public:
+    struct ZoneSummary {
+        std::string_view name;
+        std::uint64_t count;
+        double mean_us;
+        // Percentiles are bucket upper bounds, so they are accurate to within a factor of two.
+        double p50_us;
+        double p99_us;
+        double max_us;
+    };
+
+    static bool enabled() noexcept { return enabled_flag.load(std::memory_order_relaxed); }
+
+    // Call before the threads to be traced are started, trace buffers are sized on a thread's
+    // first recorded zone.
+    static void enable(bool trace = false) noexcept;
+    static void disable() noexcept;
+
+    static void record(ProfZone z, long beg_ns, long end_ns) noexcept;
+
+    static std::vector<ZoneSummary> summarize();
+    static void log_summary();
+    // Writes every buffered zone as Chrome trace-event JSON (chrome://tracing, Perfetto).
+    static bool write_trace(const std::string &path);
+
+    static std::string_view zone_name(ProfZone z) noexcept;
+
+private:
+    static inline std::atomic<bool> enabled_flag{false};
+};
+
+class ProfScope final {
+public:
+    explicit ProfScope(ProfZone z) noexcept : zone(z), active(Profiler::enabled()) {
+        if (active) {
+            beg_ns = gettime_highres();
+        }
+    }
+
+    ~ProfScope() {
+        if (active) {
+            Profiler::record(zone, beg_ns, gettime_highres());
+        }
+    }
+
+    ProfScope(const ProfScope &) = delete;
+    ProfScope &operator=(const ProfScope &) = delete;
+
+private:
+    ProfZone zone;
+    bool active;
+    long beg_ns{};
+};
+}  // namespace utils
+
+#define PROF_CONCAT_IMPL(a, b) a##b
+#define PROF_CONCAT(a, b) PROF_CONCAT_IMPL(a, b)
+
+#ifndef SPLAYER_NO_PROFILE
+#define PROF_ZONE(zone) \
+    const utils::ProfScope PROF_CONCAT(prof_scope_, __LINE__) { utils::ProfZone::zone }
+#else
+#define PROF_ZONE(zone) static_cast<void>(0)
+#endif
+
+#endif /* PROFILER_H_ */
@@ -0,0 +1,126 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SPSC_QUEUE_H_
+#define SPSC_QUEUE_H_
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace utils {
+// Bounded lock-free single-producer/single-consumer ring. Exactly one thread may push and exactly
+// one (possibly different) thread may pop. `size()` and `peak_size()` may be read from anywhere.
+template <typename T>
+class SpscQueue final {
+public:
+    using size_type = std::size_t;
+
+    explicit SpscQueue(size_type capacity)
+        : slots(std::bit_ceil(capacity < 1 ? size_type{1} : capacity)),
+          mask(slots.size() - 1),
+          cap(capacity < 1 ? size_type{1} : capacity) {}
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    // Producer side
+    bool try_push(T &&v) {
+        const auto t = tail.load(std::memory_order_relaxed);
+        if (t - head_cache == cap) {
+            head_cache = head.load(std::memory_order_acquire);
+            if (t - head_cache == cap) {
+                return false;
+            }
+        }
+
+        slots[t & mask] = std::move(v);
+        tail.store(t + 1, std::memory_order_release);
+
+        // `head_cache` is only refreshed when the ring looks full, so this is an upper bound. Check
+        // it against the real head before recording a new peak.
+        if (t + 1 - head_cache > peak.load(std::memory_order_relaxed)) {
+            head_cache = head.load(std::memory_order_acquire);
+            const auto sz = t + 1 - head_cache;
+            if (sz > peak.load(std::memory_order_relaxed)) {
+                peak.store(sz, std::memory_order_relaxed);
+            }
+        }
+
+        return true;
+    }
+
+    // Consumer side
+    bool try_pop(T &out) {
+        const auto h = head.load(std::memory_order_relaxed);
+        if (h == tail_cache) {
+            tail_cache = tail.load(std::memory_order_acquire);
+            if (h == tail_cache) {
+                return false;
+            }
+        }
+
+        out = std::move(slots[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side; the returned element stays valid until the next `try_pop`.
+    T *front() {
+        const auto h = head.load(std::memory_order_relaxed);
+        if (h == tail_cache) {
+            tail_cache = tail.load(std::memory_order_acquire);
+            if (h == tail_cache) {
+                return nullptr;
+            }
+        }
+
+        return &slots[h & mask];
+    }
+
+    size_type size() const noexcept {
+        const auto h = head.load(std::memory_order_acquire);
+        const auto t = tail.load(std::memory_order_acquire);
+        return (t >= h ? t - h : 0);
+    }
+
+    bool empty() const noexcept { return size() == 0; }
+    size_type capacity() const noexcept { return cap; }
+    size_type peak_size() const noexcept { return peak.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_type CACHE_LINE = 64;
+
+    std::vector<T> slots;
+    const size_type mask;
+    const size_type cap;
+
+    alignas(CACHE_LINE) std::atomic<size_type> head{0};
+    size_type tail_cache{0};
+    alignas(CACHE_LINE) std::atomic<size_type> tail{0};
+    size_type head_cache{0};
+    std::atomic<size_type> peak{0};
+};
+}  // namespace utils
+
+#endif /* SPSC_QUEUE_H_ */
@@ -0,0 +1,110 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "thread_pool.h"
+
+#include <utility>
+
+namespace utils {
+ThreadPool::ThreadPool(std::size_t workers) {
+    threads.reserve(workers);
+    for (std::size_t i = 0; i < workers; ++i) {
+        threads.emplace_back([this] { worker_loop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        const std::lock_guard lk(mtx);
+        stopping = true;
+    }
+    work_cv.notify_all();
+
+    for (auto &t : threads) {
+        t.join();
+    }
+}
+
+void ThreadPool::run_job(std::size_t count, Job j) {
+    if (count == 0) {
+        return;
+    }
+
+    std::unique_lock lk(mtx);
+    job = j;
+    job_count = count;
+    next_task = 0;
+    remaining = count;
+    error = nullptr;
+    generation += 1;
+
+    if (count > 1) {
+        work_cv.notify_all();
+    }
+
+    run_tasks(lk);
+    done_cv.wait(lk, [this] { return remaining == 0; });
+    job = {};
+
+    if (error) {
+        std::rethrow_exception(std::exchange(error, nullptr));
+    }
+}
+
+void ThreadPool::run_tasks(std::unique_lock<std::mutex> &lk) {
+    while (job.call && next_task < job_count) {
+        const auto i = next_task++;
+        const auto j = job;
+
+        lk.unlock();
+        try {
+            j.call(j.fn, i);
+        } catch (...) {
+            lk.lock();
+            if (!error) {
+                error = std::current_exception();
+            }
+            lk.unlock();
+        }
+        lk.lock();
+
+        if (--remaining == 0) {
+            done_cv.notify_all();
+        }
+    }
+}
+
+void ThreadPool::worker_loop() {
+    std::unique_lock lk(mtx);
+    std::uint64_t seen = generation;
+
+    while (true) {
+        work_cv.wait(lk, [&] { return stopping || generation != seen; });
+        if (stopping) {
+            return;
+        }
+
+        seen = generation;
+        run_tasks(lk);
+    }
+}
+}  // namespace utils
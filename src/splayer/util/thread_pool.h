@@ -0,0 +1,85 @@
+// MIT License
+//
+// Copyright (c) 2022 Bennett Anderson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace utils {
+// Fixed set of workers for fork-join work such as slicing one frame. `run` blocks and the calling
+// thread takes tasks too, so a pool of N workers executes up to N + 1 tasks at once.
+class ThreadPool final {
+public:
+    explicit ThreadPool(std::size_t workers);
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+    ~ThreadPool();
+
+    // Calls `fn(i)` for every i in [0, count) and returns once all calls finished. The first
+    // exception thrown by a task is rethrown here. Not reentrant. `fn` is only referenced for the
+    // duration of the call, so handing over a capturing lambda never allocates.
+    template <typename Fn>
+    void run(std::size_t count, Fn &&fn) {
+        using F = std::remove_reference_t<Fn>;
+        run_job(count, Job{const_cast<void *>(static_cast<const void *>(std::addressof(fn))),
+                           [](void *f, std::size_t i) { (*static_cast<F *>(f))(i); }});
+    }
+
+    std::size_t workers() const noexcept { return threads.size(); }
+
+private:
+    // Non-owning view of the callable passed to `run`
+    struct Job {
+        void *fn{nullptr};
+        void (*call)(void *fn, std::size_t i){nullptr};
+    };
+
+    void run_job(std::size_t count, Job j);
+    void worker_loop();
+    void run_tasks(std::unique_lock<std::mutex> &lk);
+
+    std::mutex mtx;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+
+    Job job{};
+    std::size_t job_count{};
+    std::size_t next_task{};
+    std::size_t remaining{};
+    std::uint64_t generation{};
+    std::exception_ptr error;
+    bool stopping{false};
+
+    std::vector<std::thread> threads;
+};
+}  // namespace utils
+
+#endif /* THREAD_POOL_H_ */
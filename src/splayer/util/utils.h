@@ -29,6 +29,7 @@
     do {                                                                     \
         if ((x) != 0) [[unlikely]] {                                         \
             utils::Log(utils::Log::ERROR) << #x << " did not evaluate to 0"; \
+            utils::Log::flush();                                             \
             std::abort();                                                    \
         }                                                                    \
     } while (0)
@@ -37,6 +38,7 @@
     do {                                                                      \
         if (!(x)) [[unlikely]] {                                              \
             utils::Log(utils::Log::ERROR) << "Assertion " << #x << " failed"; \
+            utils::Log::flush();                                              \
             std::abort();                                                     \
         }                                                                     \
     } while (0)
@@ -22,11 +22,17 @@
 
 #include "window.h"
 
+#include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <splayer/util/log.h>
+#include <splayer/util/profiler.h>
 
+#include <algorithm>
 #include <cmath>
+#include <exception>
 #include <iostream>
+#include <string_view>
+#include <thread>
 
 namespace graphics {
 static bool cursor_pos_checks(double xpos, double ypos) noexcept {
@@ -55,6 +61,50 @@ void Window::set_with_click_ratio(Window *win, double &xpos, double &ypos) {
     ypos *= hratio;
 }
 
+void Window::glfw_framebuffer_size_callback(GLFWwindow *window, int w, int h) noexcept {
+    Window *us = static_cast<Window *>(glfwGetWindowUserPointer(window));
+    us->window_width.store(w, std::memory_order_relaxed);
+    us->window_height.store(h, std::memory_order_relaxed);
+}
+
+void DurationHistogram::add(long ns) noexcept {
+    const auto b = std::min(static_cast<std::size_t>(std::max(ns, 0L) / BUCKET_NS), BUCKETS - 1);
+    buckets[b] += 1;
+    count += 1;
+    max_ns = std::max(max_ns, ns);
+}
+
+DurationHistogram::Summary DurationHistogram::summarize() const noexcept {
+    // Upper bound of the bucket holding the sample at fraction `p`
+    const auto percentile_ms = [this](double p) {
+        const auto rank = static_cast<std::uint64_t>(std::ceil(p * static_cast<double>(count)));
+        std::uint64_t seen{};
+
+        for (std::size_t b = 0; b < BUCKETS; ++b) {
+            seen += buckets[b];
+            if (seen >= rank) {
+                return static_cast<double>((static_cast<long>(b) + 1) * BUCKET_NS) / 1e6;
+            }
+        }
+
+        return static_cast<double>(max_ns) / 1e6;
+    };
+
+    if (count == 0) {
+        return {};
+    }
+
+    return {count, percentile_ms(0.5), percentile_ms(0.99), static_cast<double>(max_ns) / 1e6};
+}
+
+void Window::post_input(const InputStats &stat) noexcept {
+    InputStats s = stat;
+    s.time_ns = utils::gettime_highres();
+    if (!input_q.try_push(std::move(s))) {
+        dropped_inputs += 1;
+    }
+}
+
 void Window::glfw_error_callback([[maybe_unused]] int error, const char *description) {
     utils::Log(utils::Log::ERROR) << "glfw error: " << description;
 }
@@ -68,7 +118,7 @@ void Window::glfw_cursor_pos_callback(GLFWwindow *window, double xpos, double yp
     }
 
     if (us->input_cb) {
-        us->input_cb({.type = InputStatType::MOUSE_MOVE,
+        us->post_input({.type = InputStatType::MOUSE_MOVE,
             .x_pos = static_cast<std::uint_fast32_t>(xpos),
             .y_pos = static_cast<std::uint_fast32_t>(ypos)});
     }
@@ -89,11 +139,11 @@ void Window::glfw_cursor_button_callback(GLFWwindow *window, int button, int act
     }
 
     if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
-        us->input_cb({.type = InputStatType::LEFT_MOUSE_PRESS,
+        us->post_input({.type = InputStatType::LEFT_MOUSE_PRESS,
             .x_pos = static_cast<std::uint_fast32_t>(xpos),
             .y_pos = static_cast<std::uint_fast32_t>(ypos)});
     } else if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_RELEASE) {
-        us->input_cb({.type = InputStatType::LEFT_MOUSE_RELEASE,
+        us->post_input({.type = InputStatType::LEFT_MOUSE_RELEASE,
             .x_pos = static_cast<std::uint_fast32_t>(xpos),
             .y_pos = static_cast<std::uint_fast32_t>(ypos)});
     }
@@ -110,7 +160,7 @@ void Window::glfw_char_callback(GLFWwindow *window, unsigned int key) noexcept {
         return;
     }
 
-    us->input_cb({.type = InputStatType::KEY_INPUT, .key = static_cast<std::uint_fast32_t>(key)});
+    us->post_input({.type = InputStatType::KEY_INPUT, .key = static_cast<std::uint_fast32_t>(key)});
 }
 
 void Window::glfw_key_callback(
@@ -162,7 +212,9 @@ void Window::glfw_key_callback(
             return;
     }
 
-    us->input_cb(stat);
+    if (us->input_cb) {
+        us->post_input(stat);
+    }
 }
 
 Window::Window() {
@@ -186,32 +238,105 @@ void Window::window_loop(std::function<void()> func) {
         throw std::runtime_error("Invalid window loop cb passed");
     }
 
-    while (!glfwWindowShouldClose(window)) {
-        int win_width, win_height;
-        glfwGetFramebufferSize(window, &win_width, &win_height);
-        window_width = win_width;
-        window_height = win_height;
+    query_true_window_dims();
+
+    // The context follows the render thread and comes back once it is done
+    glfwMakeContextCurrent(nullptr);
+    render_running = true;
+
+    std::exception_ptr render_error;
+    std::thread render_thread([&] {
+        try {
+            render_loop(func);
+        } catch (...) {
+            render_error = std::current_exception();
+        }
+
+        glfwMakeContextCurrent(nullptr);
+        render_running = false;
+        glfwPostEmptyEvent();
+    });
+
+    // Blocks only here, in the platform's event handling, so a modal move or resize loop no longer
+    // holds up a frame.
+    while (render_running) {
+        glfwWaitEvents();
+        apply_pending_aspect_r();
+    }
+
+    glfwSetWindowShouldClose(window, GLFW_TRUE);
+    render_thread.join();
+    glfwMakeContextCurrent(window);
+
+    if (dropped_inputs) {
+        SPLAYER_LOG(INFO) << "Input events dropped " << dropped_inputs;
+    }
+
+    const auto log_series = [](std::string_view what, const DurationHistogram::Summary &st) {
+        if (st.count > 0) {
+            SPLAYER_LOG(INFO) << what << " n=" << st.count << " p50<=" << st.p50_ms
+                              << "ms p99<=" << st.p99_ms << "ms max=" << st.max_ms << "ms";
+        }
+    };
+
+    log_series("Frame interval", frame_interval_stats());
+    log_series("Input to present", input_latency_stats());
+
+    if (render_error) {
+        std::rethrow_exception(render_error);
+    }
+}
+
+void Window::render_loop(const std::function<void()> &func) {
+    glfwMakeContextCurrent(window);
+    long last_swap_ns{};
 
+    while (!glfwWindowShouldClose(window)) {
+        // Input gathered by the event thread since the last frame
+        InputStats stat;
+        long oldest_input_ns{-1};
+        while (input_q.try_pop(stat)) {
+            if (oldest_input_ns < 0) {
+                oldest_input_ns = stat.time_ns;
+            }
+
+            input_cb(stat);
+        }
+
+        const auto [win_width, win_height] = get_window_dims();
         glViewport(0, 0, win_width, win_height);
-        glMatrixMode(GL_PROJECTION);
-        glLoadIdentity();
-        glOrtho(0, win_width, win_height, 0, -1, 1);
-        glMatrixMode(GL_MODELVIEW);
 
         // User-provided callback
         func();
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        {
+            PROF_ZONE(SWAP_BUFFERS);
+            glfwSwapBuffers(window);
+        }
+
+        const auto now_ns = utils::gettime_highres();
+        if (last_swap_ns > 0) {
+            frame_intervals.add(now_ns - last_swap_ns);
+        }
+
+        if (oldest_input_ns >= 0) {
+            input_latency.add(now_ns - oldest_input_ns);
+        }
+
+        last_swap_ns = now_ns;
     }
 }
 
-void Window::create_window(const std::string &title, int w, int h) {
+void Window::create_window(const std::string &title, int w, int h, bool visible) {
     initial_win_width = w;
     initial_win_height = h;
 
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+    // Core profile only, forward compatible for macOS which has no other way to get past 2.1
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
+    glfwWindowHint(GLFW_VISIBLE, visible ? GLFW_TRUE : GLFW_FALSE);
 
     window = glfwCreateWindow(w, h, title.c_str(), nullptr, nullptr);
     if (window == nullptr) {
@@ -224,12 +349,64 @@ void Window::create_window(const std::string &title, int w, int h) {
     glfwSetMouseButtonCallback(window, glfw_cursor_button_callback);
     glfwSetCharCallback(window, glfw_char_callback);
     glfwSetKeyCallback(window, glfw_key_callback);
+    glfwSetFramebufferSizeCallback(window, glfw_framebuffer_size_callback);
 
     glfwMakeContextCurrent(window);
     glfwSwapInterval(1);
+
+    // GLEW looks up core entry points through the extension string unless told otherwise, which
+    // core contexts no longer have
+    glewExperimental = GL_TRUE;
+    const auto err = glewInit();
+    if (err != GLEW_OK) {
+        utils::Log(utils::Log::ERROR)
+            << "glewInit failed: " << reinterpret_cast<const char *>(glewGetErrorString(err));
+        throw std::runtime_error("Failed to load OpenGL entry points");
+    }
+
+    // glewInit's own probing leaves GL_INVALID_ENUM behind on core contexts
+    glGetError();
 }
 
-void Window::force_consistent_aspect_r(int w, int h) { glfwSetWindowAspectRatio(window, w, h); }
+void Window::force_consistent_aspect_r(int w, int h) {
+    const auto packed = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(w)) << 32) |
+                        static_cast<std::uint32_t>(h);
+
+    if (!render_running) {
+        pending_aspect_r.store(packed);
+        apply_pending_aspect_r();
+        return;
+    }
+
+    // Window attributes belong to the event thread, wake it only when there is something new
+    if (pending_aspect_r.exchange(packed) != packed) {
+        glfwPostEmptyEvent();
+    }
+}
+
+void Window::request_close() noexcept {
+    glfwSetWindowShouldClose(window, GLFW_TRUE);
+    glfwPostEmptyEvent();
+}
+
+DurationHistogram::Summary Window::frame_interval_stats() const noexcept {
+    return frame_intervals.summarize();
+}
+
+DurationHistogram::Summary Window::input_latency_stats() const noexcept {
+    return input_latency.summarize();
+}
+
+void Window::apply_pending_aspect_r() {
+    const auto packed = pending_aspect_r.load();
+    if (packed == applied_aspect_r) {
+        return;
+    }
+
+    applied_aspect_r = packed;
+    glfwSetWindowAspectRatio(
+        window, static_cast<int>(packed >> 32), static_cast<int>(packed & 0xffffffff));
+}
 
 std::tuple<int, int> Window::get_primary_monitor_dims() {
     auto prim_monitor = glfwGetPrimaryMonitor();
@@ -23,8 +23,15 @@
 #ifndef WINDOW_H_
 #define WINDOW_H_
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <string>
+#include <tuple>
+
+#include <splayer/util/spsc_queue.h>
 
 struct GLFWwindow;
 
@@ -59,6 +66,31 @@ struct InputStats {
     std::uint_fast32_t key;
     std::uint_fast32_t x_pos;
     std::uint_fast32_t y_pos;
+    // When the event thread received it, see `utils::gettime_highres`
+    long time_ns;
+};
+
+// Durations in fixed 0.1 ms buckets up to 100 ms, longer ones share the last bucket. Recording
+// never allocates, so it can stay on in the render loop.
+class DurationHistogram {
+public:
+    struct Summary {
+        std::uint64_t count;
+        double p50_ms;
+        double p99_ms;
+        double max_ms;
+    };
+
+    void add(long ns) noexcept;
+    Summary summarize() const noexcept;
+
+private:
+    static constexpr long BUCKET_NS = 100'000;
+    static constexpr std::size_t BUCKETS = 1000;
+
+    std::array<std::uint32_t, BUCKETS> buckets{};
+    std::uint64_t count{};
+    long max_ns{};
 };
 
 class Window {
@@ -69,13 +101,27 @@ public:
     Window(Window &&) = delete;
     Window &operator=(const Window &) = delete;
     Window &operator=(Window &&) = delete;
-    void create_window(const std::string &title, int w, int h);
+    // Creates the window with an OpenGL 3.3 core context current on the calling thread. A hidden
+    // window still renders, e.g. for offscreen use on a software rasterizer.
+    void create_window(const std::string &title, int w, int h, bool visible = true);
+    // Runs `func` once per refresh on a render thread that owns the GL context for the duration,
+    // while the calling (main) thread only handles window events. Input reaches `input_cb` on the
+    // render thread, ahead of the next `func`. Returns with the context current again once the
+    // window is closed, rethrowing whatever `func` threw.
     void window_loop(std::function<void()> func);
+    // Framebuffer size, may be read from any thread
     std::tuple<int, int> get_window_dims() const { return {window_width, window_height}; }
     std::tuple<int, int> query_true_window_dims();
     void set_input_cb(InputCbSignature cb) { input_cb = cb; }
     std::tuple<int, int> get_primary_monitor_dims();
+    // May be called from the render thread, the event thread applies it.
     void force_consistent_aspect_r(int w, int h);
+    // Ends `window_loop` after the current refresh, may be called from any thread.
+    void request_close() noexcept;
+    // Time between buffer swaps, and from an input event to the swap of the first frame rendered
+    // after it was handled. Only valid while `window_loop` isn't running.
+    DurationHistogram::Summary frame_interval_stats() const noexcept;
+    DurationHistogram::Summary input_latency_stats() const noexcept;
 
     ~Window();
 
@@ -87,11 +133,30 @@ private:
     static void glfw_char_callback(GLFWwindow *window, unsigned int codepoint) noexcept;
     static void glfw_key_callback(
         GLFWwindow *window, int key, int scancode, int action, int mods) noexcept;
+    static void glfw_framebuffer_size_callback(GLFWwindow *window, int w, int h) noexcept;
     static void set_with_click_ratio(Window *win, double &xpos, double &ypos);
+    void post_input(const InputStats &stat) noexcept;
+    void render_loop(const std::function<void()> &func);
+    void apply_pending_aspect_r();
+
+    static constexpr std::size_t INPUT_QUEUE_SIZE = 256;
+
     GLFWwindow *window{nullptr};
-    int window_width{}, window_height{};
+    std::atomic<int> window_width{}, window_height{};
     int initial_win_width{}, initial_win_height{};
     InputCbSignature input_cb;
+
+    // Event thread to render thread
+    utils::SpscQueue<InputStats> input_q{INPUT_QUEUE_SIZE};
+    std::size_t dropped_inputs{};
+    std::atomic<bool> render_running{false};
+    // Requested and applied aspect ratio, width in the upper half
+    std::atomic<std::uint64_t> pending_aspect_r{};
+    std::uint64_t applied_aspect_r{};
+
+    // Written by the render thread
+    DurationHistogram frame_intervals;
+    DurationHistogram input_latency;
 };
 }  // namespace graphics
 